@@ -0,0 +1,167 @@
+#include "hanoi.h"
+#include "anim.h"
+#include "motion.h"
+
+#define ANIM_AXIS_Y  0x01  /* Phase moves anim_y instead of anim_x */
+#define ANIM_NEGATE  0x02  /* Subtract the velocities (up / left) */
+#define ANIM_REVERSE 0x04  /* Walk the table backwards (drop = reversed lift) */
+
+unsigned char anim_block;
+unsigned int anim_x;
+unsigned int anim_y;
+unsigned char anim_drop_tower;
+
+/* Sub-pixel part of anim_x (the playfield is wider than 8.8 can hold) */
+static unsigned char anim_x_frac;
+
+/* Current phase */
+static const unsigned int* anim_vel;  /* 0 = no phase running */
+static unsigned char anim_frames;     /* Frames left in the phase */
+static unsigned char anim_index;
+static unsigned char anim_flags;
+
+/* Drop queued behind a return slide */
+static unsigned char anim_pending_drop;
+static unsigned char anim_pending_tower;
+static unsigned char anim_pending_height;
+
+/* anim_x once the current move is over */
+static unsigned int anim_end_x;
+
+/* anim_x:anim_x_frac += v (8.8) */
+static void anim_add_x(unsigned int v) {
+    unsigned int sum = (unsigned int)anim_x_frac + (v & 0xFF);
+
+    anim_x_frac = (unsigned char)sum;
+    anim_x += (v >> 8) + (sum >> 8);
+}
+
+/* anim_x:anim_x_frac -= v (8.8) */
+static void anim_sub_x(unsigned int v) {
+    unsigned int diff = 0x100 + anim_x_frac - (v & 0xFF);
+
+    anim_x_frac = (unsigned char)diff;
+    anim_x -= (v >> 8) + 1 - (diff >> 8);
+}
+
+static void anim_start(const unsigned int* vel, unsigned char frames, unsigned char flags) {
+    anim_vel = vel;
+    anim_frames = frames;
+    anim_flags = flags;
+    anim_index = (flags & ANIM_REVERSE) ? (unsigned char)(frames - 1) : 0;
+}
+
+static void anim_start_drop(unsigned char tower, unsigned char height) {
+    anim_drop_tower = tower;
+    anim_pending_drop = 0;
+    anim_start(anim_lift_vy[height], ANIM_LIFT_FRAMES, ANIM_AXIS_Y | ANIM_REVERSE);
+}
+
+static void anim_start_slide(unsigned char from_tower, unsigned char to_tower) {
+    anim_end_x = tower_center_px[to_tower];
+    if (from_tower < to_tower) {
+        anim_start(anim_slide_vx[to_tower - from_tower - 1], ANIM_SLIDE_FRAMES, 0);
+    } else if (from_tower > to_tower) {
+        anim_start(anim_slide_vx[from_tower - to_tower - 1], ANIM_SLIDE_FRAMES, ANIM_NEGATE);
+    }
+}
+
+void anim_reset(void) {
+    anim_block = 0;
+    anim_drop_tower = 0xFF;
+    anim_vel = 0;
+    anim_pending_drop = 0;
+}
+
+void anim_finish(void) {
+    if (anim_vel == 0) {
+        return;
+    }
+    anim_vel = 0;
+
+    /* Snap to where the whole move ends */
+    anim_x = anim_end_x;
+    anim_x_frac = 0;
+    anim_y = (unsigned int)HOLD_Y << 8;
+    if (anim_pending_drop || anim_drop_tower != 0xFF) {
+        /* Disk reached its slot and is drawn as part of the stack again */
+        anim_block = 0;
+        anim_drop_tower = 0xFF;
+        anim_pending_drop = 0;
+    }
+}
+
+void anim_pickup(unsigned char block, unsigned char tower, unsigned char height) {
+    anim_finish();
+    anim_block = block;
+    anim_x = tower_center_px[tower];
+    anim_x_frac = 0;
+    anim_y = (unsigned int)BLOCK_Y(height) << 8;
+    anim_end_x = anim_x;
+    anim_start(anim_lift_vy[height], ANIM_LIFT_FRAMES, ANIM_AXIS_Y | ANIM_NEGATE);
+}
+
+void anim_slide(unsigned char from_tower, unsigned char to_tower) {
+    anim_finish();
+    anim_start_slide(from_tower, to_tower);
+}
+
+void anim_place(unsigned char tower, unsigned char height) {
+    anim_finish();
+    anim_start_drop(tower, height);
+}
+
+void anim_return(unsigned char from_tower, unsigned char tower, unsigned char height) {
+    anim_finish();
+    if (from_tower == tower) {
+        anim_start_drop(tower, height);
+        return;
+    }
+    anim_start_slide(from_tower, tower);
+    anim_pending_drop = 1;
+    anim_pending_tower = tower;
+    anim_pending_height = height;
+}
+
+unsigned char anim_update(void) {
+    unsigned int v;
+
+    if (anim_vel == 0) {
+        return 0;
+    }
+
+    v = anim_vel[anim_index];
+    if (anim_flags & ANIM_AXIS_Y) {
+        if (anim_flags & ANIM_NEGATE) {
+            anim_y -= v;
+        } else {
+            anim_y += v;
+        }
+    } else {
+        if (anim_flags & ANIM_NEGATE) {
+            anim_sub_x(v);
+        } else {
+            anim_add_x(v);
+        }
+    }
+
+    if (anim_flags & ANIM_REVERSE) {
+        anim_index--;
+    } else {
+        anim_index++;
+    }
+
+    anim_frames--;
+    if (anim_frames == 0) {
+        anim_vel = 0;
+        if (anim_pending_drop) {
+            anim_start_drop(anim_pending_tower, anim_pending_height);
+        } else if (anim_drop_tower != 0xFF) {
+            /* Landed; the disk is in the stack again but keeps its sprites
+             * until the next rebuild, at the same position. */
+            anim_block = 0;
+            anim_drop_tower = 0xFF;
+        }
+    }
+    return 1;
+}
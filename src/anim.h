@@ -0,0 +1,44 @@
+#ifndef ANIM_H
+#define ANIM_H
+
+/*
+ * Disk motion: lift, slide and drop of the one disk in flight.
+ * Game logic changes state instantly; this module only tracks where the
+ * moving disk is drawn. Each move starts by completing the previous one,
+ * so input is never held up by an animation. Per-frame cost is one 16-bit
+ * table add plus redrawing at most MAX_BLOCKS sprites.
+ */
+
+/* Disk in flight or held (0 = none) and its position: anim_x is the
+ * disk's center in whole playfield pixels (0-511, fraction kept
+ * internally), anim_y its top edge as 8.8 screen pixels. */
+extern unsigned char anim_block;
+extern unsigned int anim_x;
+extern unsigned int anim_y;
+
+/* Tower whose top disk is still dropping into place (0xFF = none);
+ * the renderer skips that disk in the stack and draws it from anim_x/y. */
+extern unsigned char anim_drop_tower;
+
+/* Nothing in flight (level start) */
+void anim_reset(void);
+
+/* Disk just taken from slot `height` of `tower`: lift it to HOLD_Y */
+void anim_pickup(unsigned char block, unsigned char tower, unsigned char height);
+
+/* Held disk follows the cursor from one tower to another */
+void anim_slide(unsigned char from_tower, unsigned char to_tower);
+
+/* Held disk placed into slot `height` of `tower`, which it hovers over */
+void anim_place(unsigned char tower, unsigned char height);
+
+/* Cancel: slide from `from_tower` back to `tower`, then drop into `height` */
+void anim_return(unsigned char from_tower, unsigned char tower, unsigned char height);
+
+/* Complete the current move instantly */
+void anim_finish(void);
+
+/* Advance one frame; returns 1 if the disk moved */
+unsigned char anim_update(void);
+
+#endif /* ANIM_H */
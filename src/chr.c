@@ -0,0 +1,60 @@
+#include "nes.h"
+#include "chr.h"
+#include "vram.h"
+
+#define SHIMMER_FRAMES 4  /* Frames per band step */
+
+/* Transparent band per row, one pixel further right each row */
+static const unsigned char shimmer_band[8] = {
+    0xC0, 0x60, 0x30, 0x18, 0x0C, 0x06, 0x03, 0x81
+};
+
+static unsigned char shimmer_value;  /* Pixel value 1-3 of the base tile; 0 = off */
+static unsigned char shimmer_phase;
+static unsigned char shimmer_timer;
+
+/* Queue the shimmer tile's 16 pattern bytes for the next vblank */
+static void queue_shimmer(void) {
+    unsigned char* dst = vram_begin(CHR_SHIMMER_TILE * 16, 16);
+    unsigned char row;
+    unsigned char bits;
+
+    if (dst == 0) {
+        return;  /* Queue full; the next step redraws it */
+    }
+    for (row = 0; row < 8; row++) {
+        bits = ~shimmer_band[(row + shimmer_phase) & 7];
+        dst[row] = (shimmer_value & 1) ? bits : 0;
+        dst[row + 8] = (shimmer_value & 2) ? bits : 0;
+    }
+}
+
+void chr_shimmer_tile(unsigned char base_tile) {
+    unsigned char value;
+
+    switch (base_tile) {
+        case 0x08: value = 1; break;
+        case 0x09: value = 2; break;
+        case 0x01: value = 3; break;
+        default:   value = 0; break;
+    }
+    if (value == shimmer_value) {
+        return;
+    }
+
+    /* New color: rewrite the tile now rather than at the next step */
+    shimmer_value = value;
+    shimmer_timer = SHIMMER_FRAMES;
+    if (value != 0) {
+        queue_shimmer();
+    }
+}
+
+void chr_shimmer_step(void) {
+    if (shimmer_value == 0 || --shimmer_timer != 0) {
+        return;
+    }
+    shimmer_timer = SHIMMER_FRAMES;
+    shimmer_phase++;
+    queue_shimmer();
+}
@@ -0,0 +1,27 @@
+#ifndef CHR_H
+#define CHR_H
+
+/*
+ * CHR-RAM board (make chrram, built with CHR_RAM defined). Tiles live
+ * packed in PRG-ROM and are copied to the pattern tables at boot; after
+ * that, tile patterns can change at runtime through the VRAM queue.
+ *
+ * The disk in flight is drawn with CHR_SHIMMER_TILE: a copy of its solid
+ * tile with a transparent diagonal band that sweeps across it.
+ */
+
+/* Blank tile in the ROM set, rewritten at runtime */
+#define CHR_SHIMMER_TILE 0x0A
+
+/* Copy the packed tiles into CHR-RAM (src/chr_unpack.s). Rendering must be
+ * off; takes under one frame. */
+void chr_unpack(void);
+
+/* Make the shimmer tile a copy of solid tile $01, $08 or $09; any other
+ * tile stops the animation */
+void chr_shimmer_tile(unsigned char base_tile);
+
+/* Queue the next band position; call every frame */
+void chr_shimmer_step(void);
+
+#endif /* CHR_H */
@@ -225,5 +225,36 @@
 .byte $7E,$02,$04,$08,$10,$20,$7E,$00
 .byte $7E,$02,$04,$08,$10,$20,$7E,$00
 
+; Tiles $5B-$5F: Reserved
+.res $0050, $00
+
+; Tiles $60-$65: Race mode disk edges (src/race.c). Race disks are
+; background tiles, centered on a solid $08/$09/$01 tile, 4 pixels wider
+; per size.
+
+; Tile $60: Left edge of race disk 2 (color 2, 2 pixels)
+.byte $00,$00,$00,$00,$00,$00,$00,$00
+.byte $03,$03,$03,$03,$03,$03,$03,$03
+
+; Tile $61: Right edge of race disk 2 (color 2, 2 pixels)
+.byte $00,$00,$00,$00,$00,$00,$00,$00
+.byte $C0,$C0,$C0,$C0,$C0,$C0,$C0,$C0
+
+; Tile $62: Left edge of race disk 3 (color 3, 4 pixels)
+.byte $0F,$0F,$0F,$0F,$0F,$0F,$0F,$0F
+.byte $0F,$0F,$0F,$0F,$0F,$0F,$0F,$0F
+
+; Tile $63: Right edge of race disk 3 (color 3, 4 pixels)
+.byte $F0,$F0,$F0,$F0,$F0,$F0,$F0,$F0
+.byte $F0,$F0,$F0,$F0,$F0,$F0,$F0,$F0
+
+; Tile $64: Left edge of race disk 4 (color 1, 6 pixels)
+.byte $3F,$3F,$3F,$3F,$3F,$3F,$3F,$3F
+.byte $00,$00,$00,$00,$00,$00,$00,$00
+
+; Tile $65: Right edge of race disk 4 (color 1, 6 pixels)
+.byte $FC,$FC,$FC,$FC,$FC,$FC,$FC,$FC
+.byte $00,$00,$00,$00,$00,$00,$00,$00
+
 ; Fill remaining CHR ROM space to 8KB total (0x2000 bytes)
-.res $0A50  ; Remaining space filled with zeros
+.res $09A0  ; Remaining space filled with zeros
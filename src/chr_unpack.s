@@ -0,0 +1,109 @@
+; CHR-RAM loader for the UNROM build (make chrram)
+; Copies the tile stream written by tools/gen_chr_pack.py into the pattern
+; tables at $0000. Each tile is a mode byte and its plane data:
+;   $01 plane 1 = plane 0, $02 plane 1 zero, $03 plane 0 zero (8 bytes),
+;   $04 raw (16 bytes), $80+n n blank tiles, $FF end.
+; About 16 cycles per byte copied; all the used tiles land within one frame.
+
+.export _chr_unpack, _chr_unpack_done
+.import _chr_pack
+.importzp ptr1, tmp1
+
+PPU_STATUS = $2002
+PPU_ADDR   = $2006
+PPU_DATA   = $2007
+
+CHR_COPY = $01
+CHR_LO   = $02
+CHR_HI   = $03
+
+.segment "CODE"
+
+; UNROM has bus conflicts: the bank number written must match the ROM byte
+; under it. CODE is in the fixed bank at $C000.
+bank_zero:
+    .byte $00
+
+; void chr_unpack(void);
+; Rendering must be off. Selects PRG bank 0 (RODATA, which holds the stream)
+; first: the switchable bank is undefined at power-on.
+_chr_unpack:
+    lda #$00
+    sta bank_zero
+    bit PPU_STATUS
+    sta PPU_ADDR
+    sta PPU_ADDR
+    lda #<_chr_pack
+    sta ptr1
+    lda #>_chr_pack
+    sta ptr1+1
+
+@tile:
+    ldy #$00
+    lda (ptr1),y
+    bmi @blank
+    sta tmp1
+    iny
+    cmp #CHR_HI
+    beq @hi_only
+    jsr copy8           ; Plane 0
+    lda tmp1
+    cmp #CHR_LO
+    beq @lo_only
+    cmp #CHR_COPY
+    bne @raw
+    ldy #$01            ; Plane 1 = plane 0: read it again
+@raw:
+    jsr copy8           ; Plane 1
+    jmp @advance
+@lo_only:
+    jsr zero8
+    jmp @advance
+@hi_only:
+    jsr zero8
+    jsr copy8
+
+@advance:               ; Y = stream bytes this tile used
+    tya
+    clc
+    adc ptr1
+    sta ptr1
+    bcc @tile
+    inc ptr1+1
+    jmp @tile
+
+@blank:
+    cmp #$FF
+    beq _chr_unpack_done
+    and #$7F
+    tax
+@blank_tile:
+    jsr zero8
+    jsr zero8
+    dex
+    bne @blank_tile
+    ldy #$01
+    jmp @advance
+
+; Exported so the harness can time the loader (tools/harness/chrboot.lua)
+_chr_unpack_done:
+    rts
+
+; Copy 8 stream bytes from (ptr1),Y to PPU_DATA; Y advances by 8
+copy8:
+    ldx #$08
+@loop:
+    lda (ptr1),y
+    sta PPU_DATA
+    iny
+    dex
+    bne @loop
+    rts
+
+; Write 8 zero bytes to PPU_DATA
+zero8:
+    lda #$00
+    .repeat 8
+    sta PPU_DATA
+    .endrepeat
+    rts
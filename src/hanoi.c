@@ -1,7 +1,18 @@
 #include "nes.h"
 #include "hanoi.h"
 #include "text.h"
+#include "strings.h"
 #include "sprite.h"
+#include "vram.h"
+#include "anim.h"
+#include "frame_stewart.h"
+#include "speedrun.h"
+#include "movelog.h"
+#include "metasprite.h"
+#include "palette.h"
+#ifdef CHR_RAM
+#include "chr.h"
+#endif
 
 /* Block colors from smallest to largest */
 const unsigned char block_colors[MAX_BLOCKS] = {
@@ -15,49 +26,84 @@ const unsigned char block_colors[MAX_BLOCKS] = {
     COLOR_DEEP_BLUE     /* Block 8 (largest) */
 };
 
-static void block_sprite_style(unsigned char block_num, unsigned char* tile, unsigned char* attributes) {
-    /* Sprites use palette selection (0-3) plus tile pixel value (1/2/3) to pick a color. */
-    if (block_num <= 3) {
-        *attributes = SPRITE_PALETTE_0;
-        *tile = (block_num == 1) ? 0x08 : (block_num == 2) ? 0x09 : 0x01;
-    } else if (block_num <= 6) {
-        *attributes = SPRITE_PALETTE_1;
-        *tile = (block_num == 4) ? 0x08 : (block_num == 5) ? 0x09 : 0x01;
-    } else {
-        *attributes = SPRITE_PALETTE_2;
-        *tile = (block_num == 7) ? 0x08 : 0x09;  /* block 8 uses palette color 2 */
+/* Layout for the current peg count (tables from tools/gen_metasprites.py) */
+const unsigned char* tower_tile_x;
+const unsigned int* tower_center_px;
+unsigned int playfield_width_px;
+
+/* Horizontal scroll of the playfield below the HUD split, in pixels */
+unsigned int playfield_scroll;
+
+/* Sprites used by the in-flight disk; it always occupies the first game OAM slots */
+static unsigned char moving_block_sprites;
+
+/* Nametable address of a playfield tile; columns 32-63 live in the right nametable */
+static unsigned int playfield_addr(unsigned char col, unsigned char row) {
+    unsigned int addr = 0x2000 + ((unsigned int)row * 32);
+
+    if (col >= 32) {
+        return addr + 0x0400 + (col - 32);
     }
+    return addr + col;
 }
 
-static void write_digit_tile(unsigned int addr, unsigned char value) {
-    PPU_STATUS;
-    PPU_ADDR = (unsigned char)(addr >> 8);
-    PPU_ADDR = (unsigned char)(addr & 0xFF);
-    PPU_DATA = 0x10 + value;
-}
+/* Digit tiles are 0x10 + n; a macro so the HUD pays one call per digit, not two */
+#define write_digit_tile(addr, value) vram_put((addr), 0x10 + (value))
 
-static void write_moves_3_digits(unsigned int addr, unsigned char moves) {
+/* HUD digit fields */
+#define HUD_LEVEL_ADDR (0x2000 + (1 * 32) + 8)
+#define HUD_LIVES_ADDR (0x2000 + (1 * 32) + 20)
+#define HUD_MOVES_COL 8
+#define HUD_MOVES_ROW 3
+
+#ifdef SPRITE_HUD
+/* Moves are sprites (sprite.h): three tile numbers, no VRAM traffic */
+static void write_moves_3_digits(unsigned char moves) {
     unsigned char hundreds = moves / 100;
     unsigned char tens = (moves % 100) / 10;
     unsigned char ones = moves % 10;
+    sprite_t* dst = &oam_buffer[HUD_SPRITE_MOVES];
 
-    PPU_STATUS;
-    PPU_ADDR = (unsigned char)(addr >> 8);
-    PPU_ADDR = (unsigned char)(addr & 0xFF);
-    PPU_DATA = hundreds ? (0x10 + hundreds) : 0x00;
-    PPU_DATA = (hundreds || tens) ? (0x10 + tens) : 0x00;
-    PPU_DATA = 0x10 + ones;
+    dst[0].tile = hundreds ? (0x10 + hundreds) : 0x00;
+    dst[1].tile = (hundreds || tens) ? (0x10 + tens) : 0x00;
+    dst[2].tile = 0x10 + ones;
+}
+#else
+static void write_moves_3_digits(unsigned char moves) {
+    unsigned char hundreds = moves / 100;
+    unsigned char tens = (moves % 100) / 10;
+    unsigned char ones = moves % 10;
+    unsigned char* dst = vram_begin(0x2000 + (HUD_MOVES_ROW * 32) + HUD_MOVES_COL, 3);
+
+    if (dst == 0) {
+        return;
+    }
+    dst[0] = hundreds ? (0x10 + hundreds) : 0x00;
+    dst[1] = (hundreds || tens) ? (0x10 + tens) : 0x00;
+    dst[2] = 0x10 + ones;
+}
+#endif
+
+/* Select the playfield layout for a peg count */
+static void select_layout(unsigned char num_towers) {
+    unsigned char i = num_towers - MIN_TOWERS;
+
+    tower_tile_x = layout_tile_x[i];
+    tower_center_px = layout_center_px[i];
+    playfield_width_px = (unsigned int)layout_width_tiles[i] * 8;
 }
 
 /* Initialize game state */
-void init_game(game_state_t* game) {
+void init_game(game_state_t* game, unsigned char num_towers) {
     unsigned char i, j;
 
     game->level = 1;
     game->lives = 3;
+    game->num_towers = num_towers;
+    select_layout(num_towers);
 
     /* Clear all towers */
-    for (i = 0; i < NUM_TOWERS; i++) {
+    for (i = 0; i < MAX_TOWERS; i++) {
         game->tower_heights[i] = 0;
         for (j = 0; j < MAX_BLOCKS; j++) {
             game->towers[i][j] = 0;
@@ -67,57 +113,90 @@ void init_game(game_state_t* game) {
     game->selected_tower = 0;
     game->holding_block = 0;
     game->holding_from = 0;
+    game->first_try = 1;
+    game->streak = 0;
+    game->practice = 0;
 
     start_level(game);
 }
 
-/* Calculate minimum moves for n blocks (2^n - 1) */
-static unsigned char calc_min_moves(unsigned char n) {
-    unsigned char result = 1;
-    unsigned char i;
+/* Put every disk back on the first tower */
+static void stack_level(game_state_t* game) {
+    unsigned char i, j;
+
+    game->moves = 0;
 
-    for (i = 0; i < n; i++) {
-        result *= 2;
+    /* Clear all towers */
+    for (i = 0; i < MAX_TOWERS; i++) {
+        game->tower_heights[i] = 0;
+        for (j = 0; j < MAX_BLOCKS; j++) {
+            game->towers[i][j] = 0;
+        }
     }
 
-    return result - 1;
+    /* Place all blocks on first tower (largest to smallest) */
+    for (i = 0; i < game->num_blocks; i++) {
+        game->towers[0][i] = game->num_blocks - i;
+    }
+    game->tower_heights[0] = game->num_blocks;
+
+    game->selected_tower = 0;
+    game->holding_block = 0;
+
+    anim_reset();
 }
 
 /* Start a new level */
 void start_level(game_state_t* game) {
-    unsigned char i, j;
-
     /* Set number of blocks based on level */
     game->num_blocks = game->level;
     if (game->num_blocks > MAX_BLOCKS) {
         game->num_blocks = MAX_BLOCKS;
     }
 
-    /* Calculate minimum moves */
-    game->min_moves = calc_min_moves(game->num_blocks);
-    game->moves = 0;
+    /* Minimum moves: 2^n - 1 for 3 pegs, Frame-Stewart for 4 (build-time table) */
+    game->min_moves = par_moves[game->num_towers - MIN_TOWERS][game->num_blocks];
+    game->level_frames = 0;
 
-    /* Clear all towers */
-    for (i = 0; i < NUM_TOWERS; i++) {
+    stack_level(game);
+    movelog_reset(game->num_towers);
+    playfield_scroll = 0;
+}
+
+/* Continue a game restored from a snapshot: counters intact, stacks rebuilt
+ * from the peg of each disk (save_load_snapshot) */
+void resume_game(game_state_t* game, const unsigned char* pegs) {
+    unsigned char i, j, peg;
+
+    game->num_blocks = game->level;
+    game->min_moves = par_moves[game->num_towers - MIN_TOWERS][game->num_blocks];
+    for (i = 0; i < MAX_TOWERS; i++) {
         game->tower_heights[i] = 0;
         for (j = 0; j < MAX_BLOCKS; j++) {
             game->towers[i][j] = 0;
         }
     }
-
-    /* Place all blocks on first tower (largest to smallest) */
-    for (i = 0; i < game->num_blocks; i++) {
-        game->towers[0][i] = game->num_blocks - i;
+    /* Largest disk first, so every stack comes out sorted */
+    for (i = game->num_blocks; i > 0; i--) {
+        peg = pegs[i - 1];
+        game->towers[peg][game->tower_heights[peg]] = i;
+        game->tower_heights[peg]++;
     }
-    game->tower_heights[0] = game->num_blocks;
-
-    game->selected_tower = 0;
     game->holding_block = 0;
+    game->holding_from = 0;
+
+    select_layout(game->num_towers);
+    movelog_reset(game->num_towers);
+    /* History is not part of the snapshot: moves made before it are gone,
+     * so a replay (movelog_rewind) must not reset the level to its start */
+    movelog_dropped = (game->moves != 0);
+    anim_reset();
+    playfield_scroll = 0;
 }
 
 /* Pick up a block from a tower */
 unsigned char pickup_block(game_state_t* game, unsigned char tower) {
-    if (tower >= NUM_TOWERS) {
+    if (tower >= game->num_towers) {
         return 0;  /* Invalid tower */
     }
 
@@ -136,7 +215,7 @@ unsigned char pickup_block(game_state_t* game, unsigned char tower) {
 
 /* Place a block on a tower */
 unsigned char place_block(game_state_t* game, unsigned char tower) {
-    if (tower >= NUM_TOWERS) {
+    if (tower >= game->num_towers) {
         return 0;  /* Invalid tower */
     }
 
@@ -157,9 +236,10 @@ unsigned char place_block(game_state_t* game, unsigned char tower) {
     game->tower_heights[tower]++;
     game->holding_block = 0;
 
-    /* Increment move counter only if not returning to original tower */
+    /* Count and log the move only if not returning to original tower */
     if (tower != game->holding_from) {
         game->moves++;
+        movelog_push(game->holding_from, tower);
     }
 
     return 1;  /* Success */
@@ -167,8 +247,8 @@ unsigned char place_block(game_state_t* game, unsigned char tower) {
 
 /* Check if level is complete */
 unsigned char check_win(game_state_t* game) {
-    /* Win condition: all blocks on tower 2 (rightmost) */
-    if (game->tower_heights[2] == game->num_blocks) {
+    /* Win condition: all blocks on the rightmost tower */
+    if (game->tower_heights[game->num_towers - 1] == game->num_blocks) {
         /* Check if done in minimum moves */
         if (game->moves == game->min_moves) {
             return 1;  /* Win */
@@ -179,85 +259,124 @@ unsigned char check_win(game_state_t* game) {
     return 0;  /* Not complete */
 }
 
+/* Move the top disk for undo/redo; logged moves are always legal */
+static void move_top_block(game_state_t* game, unsigned char move) {
+    unsigned char from = MOVE_FROM(move);
+    unsigned char to = MOVE_TO(move);
+
+    game->tower_heights[from]--;
+    game->towers[to][game->tower_heights[to]] = game->towers[from][game->tower_heights[from]];
+    game->towers[from][game->tower_heights[from]] = 0;
+    game->tower_heights[to]++;
+}
+
+unsigned char undo_move(game_state_t* game) {
+    unsigned char move;
+
+    if (game->holding_block != 0) {
+        return 0;
+    }
+    move = movelog_undo();
+    if (move == MOVELOG_NONE) {
+        return 0;
+    }
+    move_top_block(game, MOVE_PACK(MOVE_TO(move), MOVE_FROM(move)));
+    game->moves--;
+    anim_reset();
+    return 1;
+}
+
+unsigned char redo_move(game_state_t* game) {
+    unsigned char move;
+
+    if (game->holding_block != 0) {
+        return 0;
+    }
+    move = movelog_redo();
+    if (move == MOVELOG_NONE) {
+        return 0;
+    }
+    move_top_block(game, move);
+    game->moves++;
+    anim_reset();
+    return 1;
+}
+
+unsigned char replay_start(game_state_t* game) {
+    if (game->holding_block != 0 || !movelog_rewind()) {
+        return 0;
+    }
+    stack_level(game);
+    return 1;
+}
+
 void render_game_background(game_state_t* game) {
     unsigned char tower, row;
     unsigned int addr;
-    unsigned char tower_x[NUM_TOWERS] = {5, 14, 23};  /* X positions of towers */
     unsigned char i;
 
-    /* Disable rendering for all PPU writes */
+    /* Disable rendering and NMI for all PPU writes */
+    PPU_CTRL = 0;
     PPU_MASK = 0;
 
-    /* Clear nametable */
+    /* Clear both nametables; the playfield scrolls across $2000 and $2400 */
     PPU_STATUS;
     PPU_ADDR = 0x20;
     PPU_ADDR = 0x00;
-    for (i = 0; i < 240; i++) {  /* Clear 240 bytes at a time for speed */
-        PPU_DATA = 0x00;
-        PPU_DATA = 0x00;
-        PPU_DATA = 0x00;
-        PPU_DATA = 0x00;
+    for (tower = 0; tower < 2; tower++) {
+        for (i = 0; i < 240; i++) {  /* Clear 240 bytes at a time for speed */
+            PPU_DATA = 0x00;
+            PPU_DATA = 0x00;
+            PPU_DATA = 0x00;
+            PPU_DATA = 0x00;
+        }
+
+        /* Clear attribute table */
+        for (i = 0; i < 64; i++) {
+            PPU_DATA = 0x00;
+        }
     }
 
-    /* Clear attribute table */
-    for (i = 0; i < 64; i++) {
-        PPU_DATA = 0x00;
+    /* HUD labels; the speedrun clock follows TIME at (19, 3) */
+    text_draw(2, 1, str_level);
+    text_draw(14, 1, str_lives);
+    text_draw(2, 3, str_moves);
+    text_draw(14, 3, str_time);
+
+    /* HUD digits (queued, flushed below while rendering is still off) */
+#ifdef SPRITE_HUD
+    /* Level and lives only change across full redraws, so only here */
+    write_digit_tile(HUD_LEVEL_ADDR, game->level);
+    write_digit_tile(HUD_LIVES_ADDR, game->lives);
+    for (i = 0; i < 3; i++) {
+        sprite_hud_place(HUD_SPRITE_MOVES + i, HUD_MOVES_COL + i, HUD_MOVES_ROW);
     }
+#endif
+    render_game_hud(game);
+    speedrun_redraw_hud();
 
-    /* Write "LEVEL" text at (2, 1) */
-    addr = 0x2000 + (1 * 32) + 2;
-    PPU_STATUS;
-    PPU_ADDR = (unsigned char)(addr >> 8);
-    PPU_ADDR = (unsigned char)(addr & 0xFF);
-    PPU_DATA = 0x4C; /* L */
-    PPU_DATA = 0x45; /* E */
-    PPU_DATA = 0x56; /* V */
-    PPU_DATA = 0x45; /* E */
-    PPU_DATA = 0x4C; /* L */
-
-    /* Write "LIVES" text at (14, 1) */
-    addr = 0x2000 + (1 * 32) + 14;
+    /* Divider under the HUD; sprite 0 sits on it to time the scroll split */
+    addr = 0x2000 + (SPLIT_ROW * 32);
     PPU_STATUS;
-    PPU_ADDR = (unsigned char)(addr >> 8);
-    PPU_ADDR = (unsigned char)(addr & 0xFF);
-    PPU_DATA = 0x4C; /* L */
-    PPU_DATA = 0x49; /* I */
-    PPU_DATA = 0x56; /* V */
-    PPU_DATA = 0x45; /* E */
-    PPU_DATA = 0x53; /* S */
-
-    /* Write "MOVES" text at (2, 3) */
-    addr = 0x2000 + (3 * 32) + 2;
-    PPU_STATUS;
-    PPU_ADDR = (unsigned char)(addr >> 8);
-    PPU_ADDR = (unsigned char)(addr & 0xFF);
-    PPU_DATA = 0x4D; /* M */
-    PPU_DATA = 0x4F; /* O */
-    PPU_DATA = 0x56; /* V */
-    PPU_DATA = 0x45; /* E */
-    PPU_DATA = 0x53; /* S */
-
-    /* HUD digits */
-    write_digit_tile(0x2000 + (1 * 32) + 8, game->level);
-    write_digit_tile(0x2000 + (1 * 32) + 20, game->lives);
-    write_moves_3_digits(0x2000 + (3 * 32) + 8, game->moves);
+    PPU_SET_ADDR(addr);
+    for (i = 0; i < 32; i++) {
+        PPU_DATA = 0x07;  /* Base tile: opaque bottom rows */
+    }
 
     /* Draw towers */
-    for (tower = 0; tower < NUM_TOWERS; tower++) {
+    for (tower = 0; tower < game->num_towers; tower++) {
         /* Draw tower pole */
         for (row = 0; row < 10; row++) {
-            addr = 0x2000 + ((row + 10) * 32) + tower_x[tower];
+            addr = playfield_addr(tower_tile_x[tower], row + 10);
             PPU_STATUS;
-            PPU_ADDR = (unsigned char)(addr >> 8);
-            PPU_ADDR = (unsigned char)(addr & 0xFF);
+            PPU_SET_ADDR(addr);
             PPU_DATA = 0x06;  /* Tower pole tile */
         }
 
         /* Draw tower base */
-        addr = 0x2000 + (20 * 32) + tower_x[tower];
+        addr = playfield_addr(tower_tile_x[tower], BASE_ROW);
         PPU_STATUS;
-        PPU_ADDR = (unsigned char)(addr >> 8);
-        PPU_ADDR = (unsigned char)(addr & 0xFF);
+        PPU_SET_ADDR(addr);
         PPU_DATA = 0x07;  /* Tower base tile */
     }
 
@@ -266,8 +385,7 @@ void render_game_background(game_state_t* game) {
     /* Bits 0-1: top-left, 2-3: top-right, 4-5: bottom-left, 6-7: bottom-right */
     addr = 0x23C0;  /* Start of attribute table */
     PPU_STATUS;
-    PPU_ADDR = (unsigned char)(addr >> 8);
-    PPU_ADDR = (unsigned char)(addr & 0xFF);
+    PPU_SET_ADDR(addr);
 
     /* First 2 rows (16 bytes) use palette 0 for text */
     for (i = 0; i < 16; i++) {
@@ -279,91 +397,171 @@ void render_game_background(game_state_t* game) {
         PPU_DATA = 0x00;  /* Palette 0 for all quadrants */
     }
 
+    /* Upload the palette and the queued HUD digits */
+    palette_upload();
+    vram_flush();
+
     /* Reset scroll and enable rendering */
     PPU_STATUS;
     PPU_SCROLL = 0;
     PPU_SCROLL = 0;
+    PPU_CTRL = PPU_CTRL_NMI;
     PPU_MASK = PPU_MASK_SHOW_BG | PPU_MASK_SHOW_SPRITES;
 }
 
 void render_game_hud(game_state_t* game) {
-    /* Update HUD digits only; caller should run this during vblank. */
-    write_digit_tile(0x2000 + (1 * 32) + 8, game->level);
-    write_digit_tile(0x2000 + (1 * 32) + 20, game->lives);
-    write_moves_3_digits(0x2000 + (3 * 32) + 8, game->moves);
+#ifdef SPRITE_HUD
+    /* Sprite tiles only; level and lives are drawn by render_game_background() */
+    write_moves_3_digits(game->moves);
+#else
+    /* Queue HUD digits only; they reach the PPU at the next vram_flush(). */
+    write_digit_tile(HUD_LEVEL_ADDR, game->level);
+    write_digit_tile(HUD_LIVES_ADDR, game->lives);
+    write_moves_3_digits(game->moves);
+#endif
+}
 
-    PPU_STATUS;
-    PPU_SCROLL = 0;
-    PPU_SCROLL = 0;
+/* Draw a metasprite at a playfield position; the one 16-bit step is the
+ * scroll, after which everything is 8-bit */
+static void draw_playfield_metasprite(unsigned int center_px, unsigned char y, unsigned char id) {
+    unsigned int sx = center_px - playfield_scroll;
+
+    metasprite_offscreen = (sx > 255);  /* Center past either edge */
+    draw_metasprite((unsigned char)sx, y, id);
 }
 
-void build_game_sprites(game_state_t* game, unsigned char show_cursor) {
-    unsigned char tower, block, col;
-    unsigned char block_width;
-    unsigned char tower_x[NUM_TOWERS] = {5, 14, 23};  /* X positions of towers */
-    unsigned char sprite_index = 0;
-
-    clear_sprites();
-
-    /* Draw blocks as sprites so each disk can be independently colored and pixel-centered */
-    for (tower = 0; tower < NUM_TOWERS; tower++) {
-        unsigned int tower_center_x = (unsigned int)tower_x[tower] * 8 + 4; /* pixel center of pole tile */
-        for (block = 0; block < game->tower_heights[tower]; block++) {
-            unsigned char block_num = game->towers[tower][block];
-            unsigned char tile;
-            unsigned char attributes;
-            int left_x;
-            unsigned char y_px;
-
-            block_width = block_num; /* in 8px tiles */
-            y_px = (unsigned char)((19 - block) * 8);
-
-            block_sprite_style(block_num, &tile, &attributes);
-
-            left_x = (int)tower_center_x - ((int)block_width * 8) / 2;
-            for (col = 0; col < block_width; col++) {
-                if (sprite_index >= 64) {
-                    break;
-                }
-                oam_buffer[sprite_index].y = (unsigned char)(y_px - 1); /* NES OAM stores Y-1 */
-                oam_buffer[sprite_index].tile = tile;
-                oam_buffer[sprite_index].attributes = attributes;
-                oam_buffer[sprite_index].x = (unsigned char)(left_x + (int)col * 8);
-                sprite_index++;
-            }
+#ifdef CHR_RAM
+/* Draw the disk in flight with the animated shimmer tile (chr.h) */
+static void shimmer_moving_block(void) {
+    unsigned char slot;
+
+    if (moving_block_sprites == 0) {
+        chr_shimmer_tile(0);
+        return;
+    }
+    chr_shimmer_tile(oam_buffer[FIRST_GAME_SPRITE].tile);
+    for (slot = FIRST_GAME_SPRITE; slot < FIRST_GAME_SPRITE + moving_block_sprites; slot++) {
+        oam_buffer[slot].tile = CHR_SHIMMER_TILE;
+    }
+}
+#endif
+
+unsigned char build_game_sprites(game_state_t* game, unsigned char show_cursor) {
+    unsigned char tower, block;
+    unsigned char height;
+    unsigned char width;
+    unsigned char row;
+    unsigned char y;
+    unsigned char total;
+    unsigned char crowded;
+    unsigned char row_sprites[MAX_BLOCKS];  /* Stack sprites on each disk row */
+    unsigned char stack_height[MAX_TOWERS];
+    const unsigned char* stack;
+
+    sprite_pool_reset();
+
+    /* Sprite 0: hidden behind the HUD divider, its hit starts the playfield scroll */
+    oam_buffer[SPRITE0_SLOT].y = (unsigned char)(SPLIT_ROW * 8 - 1);
+    oam_buffer[SPRITE0_SLOT].tile = 0x07;
+    oam_buffer[SPRITE0_SLOT].attributes = SPRITE_PALETTE_0 | SPRITE_PRIORITY;
+    oam_buffer[SPRITE0_SLOT].x = 248;
+
+    /* Count stack sprites per disk row; more than 8 on a row needs flicker */
+    for (row = 0; row < MAX_BLOCKS; row++) {
+        row_sprites[row] = 0;
+    }
+    total = 0;
+    for (tower = 0; tower < game->num_towers; tower++) {
+        height = game->tower_heights[tower];
+        if (tower == anim_drop_tower) {
+            height--;  /* Top disk is still dropping; drawn above */
+        }
+        stack_height[tower] = height;
+        stack = game->towers[tower];
+        for (block = 0; block < height; block++) {
+            width = stack[block];  /* A disk is as many sprites wide as its number */
+            row_sprites[block] += width;
+            total += width;
         }
     }
 
-    if (show_cursor && sprite_index < 64) {
-        unsigned int tower_center_x = (unsigned int)tower_x[game->selected_tower] * 8 + 4;
-
-        /* If holding a block, show it where the cursor would be for clearer feedback. */
-        if (game->holding_block != 0) {
-            unsigned char tile;
-            unsigned char attributes;
-            int left_x;
-            unsigned char y_px = (unsigned char)(9 * 8);
-
-            block_width = game->holding_block;
-            block_sprite_style(game->holding_block, &tile, &attributes);
-
-            left_x = (int)tower_center_x - ((int)block_width * 8) / 2;
-            for (col = 0; col < block_width; col++) {
-                if (sprite_index >= 64) {
-                    break;
-                }
-                oam_buffer[sprite_index].y = (unsigned char)(y_px - 1);
-                oam_buffer[sprite_index].tile = tile;
-                oam_buffer[sprite_index].attributes = attributes;
-                oam_buffer[sprite_index].x = (unsigned char)(left_x + (int)col * 8);
-                sprite_index++;
-            }
-        } else {
-            unsigned char cursor_x = (unsigned char)(tower_x[game->selected_tower] * 8);
-            oam_buffer[sprite_index].y = (unsigned char)((9 * 8) - 1);
-            oam_buffer[sprite_index].tile = 0x21;
-            oam_buffer[sprite_index].attributes = SPRITE_PALETTE_0;
-            oam_buffer[sprite_index].x = cursor_x;
+    /* Priority sprites: fixed slots, always shown. The disk in flight (or
+     * held) goes first so draw_moving_block() knows its slots. */
+    moving_block_sprites = 0;
+    if (anim_block != 0 && (anim_drop_tower != 0xFF || (show_cursor && game->holding_block != 0))) {
+        y = (unsigned char)(anim_y >> 8);
+        draw_playfield_metasprite(anim_x, y, METASPRITE_DISK(anim_block));
+        moving_block_sprites = sprite_pool_next - FIRST_GAME_SPRITE;
+
+        /* Rows it overlaps lose lines to it */
+        row = BASE_ROW - 1 - (y >> 3);
+        if (row < MAX_BLOCKS) {
+            row_sprites[row] += anim_block;
+        }
+        if ((y & 7) && (unsigned char)(row - 1) < MAX_BLOCKS) {
+            row_sprites[row - 1] += anim_block;
+        }
+    }
+#ifdef CHR_RAM
+    shimmer_moving_block();
+#endif
+    if (show_cursor && game->holding_block == 0) {
+        draw_playfield_metasprite(tower_center_px[game->selected_tower], HOLD_Y, METASPRITE_CURSOR);
+    }
+
+    crowded = 0;
+    for (row = 0; row < MAX_BLOCKS; row++) {
+        if (row_sprites[row] > SPRITES_PER_LINE) {
+            crowded = 1;
+        }
+    }
+
+    /* Stacked disks share a ring that rotates on every crowded rebuild */
+    if (crowded) {
+        sprite_pool_rotate(total);
+    }
+    for (tower = 0; tower < game->num_towers; tower++) {
+        stack = game->towers[tower];
+        for (block = 0; block < stack_height[tower]; block++) {
+            draw_playfield_metasprite(tower_center_px[tower], (unsigned char)BLOCK_Y(block),
+                                      METASPRITE_DISK(stack[block]));
         }
     }
+
+    return crowded;
+}
+
+void draw_moving_block(void) {
+    if (moving_block_sprites == 0) {
+        return;
+    }
+
+    /* Same slots as build_game_sprites() gave it: metasprites never change size */
+    sprite_pool_redraw(FIRST_GAME_SPRITE, moving_block_sprites);
+    draw_playfield_metasprite(anim_x, (unsigned char)(anim_y >> 8), METASPRITE_DISK(anim_block));
+#ifdef CHR_RAM
+    shimmer_moving_block();
+#endif
+}
+
+unsigned char update_camera(game_state_t* game) {
+    unsigned int focus;
+    unsigned int target;
+
+    /* Keep the held disk, or the selected tower, centered */
+    focus = anim_block ? anim_x : tower_center_px[game->selected_tower];
+    target = (focus > 128) ? focus - 128 : 0;
+    if (target > playfield_width_px - 256) {
+        target = playfield_width_px - 256;  /* 0 when the playfield fits on screen */
+    }
+
+    if (target == playfield_scroll) {
+        return 0;
+    }
+    if (target > playfield_scroll) {
+        playfield_scroll += (target - playfield_scroll > CAMERA_SPEED) ? CAMERA_SPEED : target - playfield_scroll;
+    } else {
+        playfield_scroll -= (playfield_scroll - target > CAMERA_SPEED) ? CAMERA_SPEED : playfield_scroll - target;
+    }
+    return 1;
 }
@@ -2,7 +2,30 @@
 #define HANOI_H
 
 #define MAX_BLOCKS 8
-#define NUM_TOWERS 3
+#define MIN_TOWERS 3                           /* Classic puzzle */
+#define MAX_TOWERS 4                           /* Reve's puzzle */
+
+/* Playfield layout (tools/gen_motion.py mirrors these) */
+#define SPLIT_ROW 5                            /* HUD divider; the playfield scrolls below it */
+#define CAMERA_SPEED 4                         /* Playfield scroll speed in pixels per frame */
+#define BASE_ROW 20                            /* Tile row of the tower bases */
+#define HOLD_Y (9 * 8)                         /* Pixel row of a held disk */
+#define BLOCK_Y(height) ((BASE_ROW - 1 - (height)) * 8)  /* Pixel row of a stack slot */
+
+/* Packed move: source tower in bits 0-1, destination tower in bits 2-3 */
+#define MOVE_PACK(from, to) ((unsigned char)((from) | ((to) << 2)))
+#define MOVE_FROM(move) ((move) & 0x03)
+#define MOVE_TO(move) (((move) >> 2) & 0x03)
+
+/* Layout for the current peg count: pole tile columns and their pixel
+ * centers in playfield coordinates, and the playfield width. Layouts wider
+ * than 256 pixels scroll across both nametables. */
+extern const unsigned char* tower_tile_x;
+extern const unsigned int* tower_center_px;
+extern unsigned int playfield_width_px;
+
+/* Current horizontal scroll of the playfield, in pixels */
+extern unsigned int playfield_scroll;
 
 /* Block colors (smallest to largest) */
 extern const unsigned char block_colors[MAX_BLOCKS];
@@ -12,21 +35,29 @@ typedef struct {
     unsigned char level;           /* Current level (1-8) */
     unsigned char lives;           /* Remaining lives (0-3) */
     unsigned char num_blocks;      /* Number of blocks for current level */
+    unsigned char num_towers;      /* Pegs in play (MIN_TOWERS-MAX_TOWERS) */
     unsigned char moves;           /* Current number of moves */
-    unsigned char min_moves;       /* Minimum moves required (2^n - 1) */
-    unsigned char towers[NUM_TOWERS][MAX_BLOCKS];  /* Tower stacks */
-    unsigned char tower_heights[NUM_TOWERS];       /* Height of each tower */
-    unsigned char selected_tower;  /* Currently selected tower (0-2) */
+    unsigned char min_moves;       /* Minimum moves required (par_moves table) */
+    unsigned char towers[MAX_TOWERS][MAX_BLOCKS];  /* Tower stacks */
+    unsigned char tower_heights[MAX_TOWERS];       /* Height of each tower */
+    unsigned char selected_tower;  /* Currently selected tower (0 to num_towers-1) */
     unsigned char holding_block;   /* Block being held (0 = none, 1-8 = block) */
     unsigned char holding_from;    /* Tower block was picked from */
+    unsigned int level_frames;     /* Gameplay frames spent on this attempt (saturates) */
+    unsigned char first_try;       /* 1 until a life is lost on the current level */
+    unsigned char streak;          /* Levels cleared on the first try in a row */
+    unsigned char practice;        /* Practice mode: undo/redo/replay, no records */
 } game_state_t;
 
-/* Initialize game state */
-void init_game(game_state_t* game);
+/* Initialize game state for a peg count (MIN_TOWERS-MAX_TOWERS) */
+void init_game(game_state_t* game, unsigned char num_towers);
 
 /* Start a new level */
 void start_level(game_state_t* game);
 
+/* Continue a game restored from a snapshot */
+void resume_game(game_state_t* game, const unsigned char* pegs);
+
 /* Pick up a block from a tower */
 unsigned char pickup_block(game_state_t* game, unsigned char tower);
 
@@ -36,9 +67,26 @@ unsigned char place_block(game_state_t* game, unsigned char tower);
 /* Check if level is complete */
 unsigned char check_win(game_state_t* game);
 
+/* Take back / repeat the last logged move (moves counter follows); 1 if done */
+unsigned char undo_move(game_state_t* game);
+unsigned char redo_move(game_state_t* game);
+
+/* Reset the towers to the level start, keeping the log for redo; 0 if the
+ * log no longer reaches back to the start */
+unsigned char replay_start(game_state_t* game);
+
 /* Render the game */
 void render_game_background(game_state_t* game);
 void render_game_hud(game_state_t* game);
-void build_game_sprites(game_state_t* game, unsigned char show_cursor);
+
+/* Rebuild OAM; returns 1 if a scanline holds more sprites than the PPU
+ * shows, in which case rebuilding every frame rotates the overflow */
+unsigned char build_game_sprites(game_state_t* game, unsigned char show_cursor);
+
+/* Move the in-flight disk's sprites to its current animation position */
+void draw_moving_block(void);
+
+/* Scroll the playfield toward the cursor; returns 1 if it moved */
+unsigned char update_camera(game_state_t* game);
 
 #endif /* HANOI_H */
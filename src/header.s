@@ -1,13 +1,16 @@
 ; iNES header for NES ROM
 ; This defines the cartridge configuration
+; The linked header comes from the SYMBOLS in the linker configuration; for
+; make chrram (nes-chrram.cfg) it is mapper 2 (UNROM), 2 * 16KB PRG-ROM and
+; no CHR-ROM (8KB CHR-RAM): bytes 5-7 become $00, $23, $00.
 
 .segment "HEADER"
     .byte "NES", $1A    ; iNES header identifier
     .byte $02           ; 2 * 16KB PRG-ROM
     .byte $01           ; 1 * 8KB CHR-ROM
-    .byte $01           ; Mapper 0, vertical mirroring
+    .byte $03           ; Mapper 0, vertical mirroring, battery-backed PRG-RAM
     .byte $00           ; Mapper 0
-    .byte $00           ; No PRG-RAM
-    .byte $00           ; NTSC
-    .byte $00           ; No special features
+    .byte $01           ; 1 * 8KB PRG-RAM at $6000
+    .byte $00           ; NTSC (iNES 1.0 TV system bit)
+    .byte $03           ; Dual NTSC/PAL compatible: region is detected at boot
     .byte $00, $00, $00, $00, $00  ; Padding
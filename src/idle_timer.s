@@ -0,0 +1,36 @@
+; Frame idle timer (wait_vblank in main.c, selfbench.c)
+; The 12-cycle vblank poll of region_timer.s, counted from the call rather
+; than from a vblank: the iterations left before the next vblank flag are
+; the frame's spare CPU time. Telemetry and the self-benchmark turn the
+; count into scanlines.
+
+.export _frame_idle
+
+PPU_STATUS = $2002
+
+.segment "CODE"
+
+; unsigned int __fastcall__ frame_idle(void);
+; Returns the iteration count in A (low) / X (high); the vblank flag is
+; consumed, so this replaces the frame's vblank wait.
+_frame_idle:
+    ldx #$00
+    ldy #$00
+    bit PPU_STATUS
+    bmi @done           ; Already in vblank: no time to spare
+@count:
+    inx                 ; 2
+    bne @poll           ; 3 (2 + iny's 2 once every 256 passes)
+    iny
+@poll:
+    bit PPU_STATUS      ; 4
+    bpl @count          ; 3
+    .assert >@count = >*, lderror, "frame_idle loop crosses a page"
+
+@done:
+    txa
+    pha
+    tya
+    tax
+    pla
+    rts
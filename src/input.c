@@ -3,6 +3,16 @@
 
 unsigned char controller1;
 unsigned char controller1_prev;
+unsigned char controller1_pressed;
+
+unsigned char pads[INPUT_PADS];
+unsigned char pads_pressed[INPUT_PADS];
+unsigned char pad_count;
+
+/* Press masks recorded while gameplay was not accepting input */
+static unsigned char input_buffer[INPUT_BUFFER_SIZE];
+static unsigned char input_buffer_head;
+static unsigned char input_buffer_count;
 
 /* Read controller state */
 void read_controller(void) {
@@ -21,14 +31,46 @@ void read_controller(void) {
         controller1 >>= 1;
         controller1 |= (CONTROLLER1 & 1) ? 0x80 : 0x00;
     }
+
+    /* Edges are computed once here; everything else tests this mask */
+    controller1_pressed = controller1 & ~controller1_prev;
 }
 
+#ifndef UNITY_BUILD
 /* Check if button was just pressed this frame */
 unsigned char button_pressed(unsigned char button) {
-    return (controller1 & button) && !(controller1_prev & button);
+    return controller1_pressed & button;
 }
 
 /* Check if button is currently held down */
 unsigned char button_held(unsigned char button) {
     return (controller1 & button);
 }
+#endif
+
+void input_buffer_store(void) {
+    unsigned char pressed = controller1_pressed & INPUT_BUFFER_MASK;
+
+    if (pressed == 0 || input_buffer_count >= INPUT_BUFFER_SIZE) {
+        return;  /* Nothing new, or full: the oldest presses win */
+    }
+    input_buffer[(input_buffer_head + input_buffer_count) & (INPUT_BUFFER_SIZE - 1)] = pressed;
+    input_buffer_count++;
+}
+
+unsigned char input_buffer_pop(void) {
+    unsigned char pressed;
+
+    if (input_buffer_count == 0) {
+        return 0;
+    }
+    pressed = input_buffer[input_buffer_head];
+    input_buffer_head = (input_buffer_head + 1) & (INPUT_BUFFER_SIZE - 1);
+    input_buffer_count--;
+    return pressed;
+}
+
+void input_buffer_clear(void) {
+    input_buffer_head = 0;
+    input_buffer_count = 0;
+}
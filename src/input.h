@@ -4,14 +4,47 @@
 /* Controller state variables */
 extern unsigned char controller1;
 extern unsigned char controller1_prev;
+extern unsigned char controller1_pressed;  /* Buttons that went down this frame */
 
-/* Read controller input */
+/* Buttons worth replaying after a transition (Start/Select are never buffered) */
+#define INPUT_BUFFER_MASK (BUTTON_A | BUTTON_B | BUTTON_LEFT | BUTTON_RIGHT)
+#define INPUT_BUFFER_SIZE 4
+
+/* Read controller input and compute controller1_pressed */
 void read_controller(void);
 
+/* Every pad, read in one strobe by read_pads() (race mode): pads 1 and 2,
+ * plus 3 and 4 when a Four Score is attached */
+#define INPUT_PADS 4
+extern unsigned char pads[INPUT_PADS];
+extern unsigned char pads_pressed[INPUT_PADS];
+extern unsigned char pad_count;  /* 2, or 4 with a Four Score */
+
+/* Read all pads (src/pads.s); controller1* follow pad 1 as in
+ * read_controller(). Call once per frame instead of it. */
+void read_pads(void);
+
+#ifdef UNITY_BUILD
+/* Single translation unit (make unity): cc65 never inlines calls, so test
+ * the masks in place instead of paying a jsr and a stack push per check */
+#define button_pressed(button) (controller1_pressed & (button))
+#define button_held(button) (controller1 & (button))
+#else
 /* Check if button was just pressed (not held) */
 unsigned char button_pressed(unsigned char button);
 
 /* Check if button is currently held down */
 unsigned char button_held(unsigned char button);
+#endif
+
+/* Remember this frame's presses (INPUT_BUFFER_MASK only) while gameplay
+ * cannot take them, e.g. during transitions and redraw frames. */
+void input_buffer_store(void);
+
+/* Oldest buffered press mask, or 0 when the buffer is empty */
+unsigned char input_buffer_pop(void);
+
+/* Drop everything buffered */
+void input_buffer_clear(void);
 
 #endif /* INPUT_H */
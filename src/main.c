@@ -5,89 +5,134 @@
 #include "hanoi.h"
 #include "sprite.h"
 #include "sfx.h"
+#include "sched.h"
+#include "vram.h"
+#include "anim.h"
+#include "split.h"
+#include "save.h"
+#include "speedrun.h"
+#include "movelog.h"
+#include "region.h"
+#include "race.h"
+#include "strings.h"
+#include "palette.h"
+#include "telemetry.h"
+#ifdef CHR_RAM
+#include "chr.h"
+#endif
+#ifdef SELFBENCH
+#include "selfbench.h"
+#endif
 
 /* Game states */
 enum {
     STATE_TITLE,
     STATE_GAMEPLAY,
     STATE_LEVEL_COMPLETE,
+    STATE_LIFE_LOST,
+    STATE_LEVEL_FAILED,
     STATE_GAME_OVER,
-    STATE_WIN_GAME
+    STATE_WIN_GAME,
+    STATE_RACE
 };
 
+/* Transition timeouts in ticks (NTSC frames, see region.h) */
+#define LEVEL_COMPLETE_FRAMES 120  /* 2 seconds on every region */
+#define LIFE_LOST_FRAMES 120
+#define LEVEL_FAILED_FRAMES 120
+
 /* Global game state */
 static unsigned char game_state;
 static game_state_t hanoi_game;
 static unsigned char frame_counter;
-static unsigned char level_complete_timer;
+static unsigned char transition_timer;  /* Scheduler slot ending the current transition */
+static sched_callback_t transition_done;  /* Leaves the current transition, after its fade-out */
 static unsigned char needs_bg_redraw;
 static unsigned char needs_hud_redraw;
 static unsigned char needs_sprite_rebuild;
+static unsigned char sprites_crowded;  /* Too many sprites on a line: rebuild (rotate) every frame */
 static unsigned char needs_nice_overlay;
+static unsigned char level_new_best;    /* Last clear beat the saved frame record */
+static unsigned char peg_mode;  /* Pegs for the next game, picked on the title */
+static unsigned char practice_mode;  /* Next game allows undo/redo/replay, picked on the title */
+static unsigned char race_mode;      /* Start begins a race (race.h), picked on the title */
+static unsigned char replay_wait;    /* Frames to the next replayed move; 0 = not replaying */
+
+#define REPLAY_FRAMES 16             /* 1x replay speed; hold A to fast-forward */
 
-/* 5x5 "big font" for title screen, using solid BG tile $08 for filled pixels. */
-static const unsigned char big_font[][25] = {
-    /* Each character is a 5x5 tile bitmap, row-major, 1=filled */
+/* 5x5 "big font" for title screen, using solid BG tile $08 for filled pixels.
+ * One byte per row, column 0 in bit 4. */
+static const unsigned char big_font[][5] = {
     /* A */
-    {0,1,1,1,0,
-     1,0,0,0,1,
-     1,1,1,1,1,
-     1,0,0,0,1,
-     1,0,0,0,1},
+    {0x0E,  /* .###. */
+     0x11,  /* #...# */
+     0x1F,  /* ##### */
+     0x11,  /* #...# */
+     0x11   /* #...# */
+    },
     /* E */
-    {1,1,1,1,1,
-     1,0,0,0,0,
-     1,1,1,1,0,
-     1,0,0,0,0,
-     1,1,1,1,1},
+    {0x1F,  /* ##### */
+     0x10,  /* #.... */
+     0x1E,  /* ####. */
+     0x10,  /* #.... */
+     0x1F   /* ##### */
+    },
     /* F */
-    {1,1,1,1,1,
-     1,0,0,0,0,
-     1,1,1,1,0,
-     1,0,0,0,0,
-     1,0,0,0,0},
+    {0x1F,  /* ##### */
+     0x10,  /* #.... */
+     0x1E,  /* ####. */
+     0x10,  /* #.... */
+     0x10   /* #.... */
+    },
     /* H */
-    {1,0,0,0,1,
-     1,0,0,0,1,
-     1,1,1,1,1,
-     1,0,0,0,1,
-     1,0,0,0,1},
+    {0x11,  /* #...# */
+     0x11,  /* #...# */
+     0x1F,  /* ##### */
+     0x11,  /* #...# */
+     0x11   /* #...# */
+    },
     /* I */
-    {1,1,1,1,1,
-     0,0,1,0,0,
-     0,0,1,0,0,
-     0,0,1,0,0,
-     1,1,1,1,1},
+    {0x1F,  /* ##### */
+     0x04,  /* ..#.. */
+     0x04,  /* ..#.. */
+     0x04,  /* ..#.. */
+     0x1F   /* ##### */
+    },
     /* N */
-    {1,0,0,0,1,
-     1,1,0,0,1,
-     1,0,1,0,1,
-     1,0,0,1,1,
-     1,0,0,0,1},
+    {0x11,  /* #...# */
+     0x19,  /* ##..# */
+     0x15,  /* #.#.# */
+     0x13,  /* #..## */
+     0x11   /* #...# */
+    },
     /* O */
-    {0,1,1,1,0,
-     1,0,0,0,1,
-     1,0,0,0,1,
-     1,0,0,0,1,
-     0,1,1,1,0},
+    {0x0E,  /* .###. */
+     0x11,  /* #...# */
+     0x11,  /* #...# */
+     0x11,  /* #...# */
+     0x0E   /* .###. */
+    },
     /* R */
-    {1,1,1,1,0,
-     1,0,0,0,1,
-     1,1,1,1,0,
-     1,0,1,0,0,
-     1,0,0,1,0},
+    {0x1E,  /* ####. */
+     0x11,  /* #...# */
+     0x1E,  /* ####. */
+     0x14,  /* #.#.. */
+     0x12   /* #..#. */
+    },
     /* T */
-    {1,1,1,1,1,
-     0,0,1,0,0,
-     0,0,1,0,0,
-     0,0,1,0,0,
-     0,0,1,0,0},
+    {0x1F,  /* ##### */
+     0x04,  /* ..#.. */
+     0x04,  /* ..#.. */
+     0x04,  /* ..#.. */
+     0x04   /* ..#.. */
+    },
     /* W */
-    {1,0,0,0,1,
-     1,0,0,0,1,
-     1,0,1,0,1,
-     1,1,0,1,1,
-     1,0,0,0,1}
+    {0x11,  /* #...# */
+     0x11,  /* #...# */
+     0x15,  /* #.#.# */
+     0x1B,  /* ##.## */
+     0x11   /* #...# */
+    }
 };
 
 enum {
@@ -103,27 +148,25 @@ enum {
     BIG_W
 };
 
-static void draw_big_char(unsigned char x0, unsigned char y0, unsigned char glyph) {
-    unsigned char r, c;
-    unsigned int base = 0x2000 + ((unsigned int)y0 * 32) + x0;
-    unsigned char big_tile = 0x08; /* Solid tile using palette color 1 */
-
-    for (r = 0; r < 5; r++) {
-        PPU_STATUS;
-        PPU_ADDR = (unsigned char)((base + (unsigned int)r * 32) >> 8);
-        PPU_ADDR = (unsigned char)((base + (unsigned int)r * 32) & 0xFF);
-        for (c = 0; c < 5; c++) {
-            PPU_DATA = big_font[glyph][r * 5 + c] ? big_tile : 0x00;
-        }
-    }
-}
-
-static void draw_big_word(unsigned char x0, unsigned char y0, const unsigned char* glyphs, unsigned char len) {
-    unsigned char idx;
-    for (idx = 0; idx < len; idx++) {
-        draw_big_char((unsigned char)(x0 + idx * 6), y0, glyphs[idx]);
-    }
-}
+/* Boot palette: the base colors of the palette shadow (palette.h) */
+static const unsigned char boot_palette[32] = {
+    /* Background palette 0 - entry 0 set per screen by palette_set_bg */
+    COLOR_BLACK, COLOR_WHITE, COLOR_GRAY, COLOR_DARK_GRAY,
+    /* Background palette 1 */
+    COLOR_BLACK, COLOR_RED, COLOR_YELLOW, COLOR_GREEN,
+    /* Background palette 2 */
+    COLOR_BLACK, COLOR_MAGENTA, COLOR_ORANGE, COLOR_TEAL,
+    /* Background palette 3 - for title screen text */
+    COLOR_BLACK, COLOR_TEAL, COLOR_WHITE, COLOR_BLUE,
+    /* Sprite palette 0 - Blocks 1-3 (Magenta, Red, Orange) */
+    COLOR_BLACK, COLOR_MAGENTA, COLOR_RED, COLOR_ORANGE,
+    /* Sprite palette 1 - Blocks 4-6 (Yellow, Yellow-Green, Green) */
+    COLOR_BLACK, COLOR_YELLOW, COLOR_YELLOW_GREEN, COLOR_GREEN,
+    /* Sprite palette 2 - Blocks 7-8 (Teal, Deep Blue) */
+    COLOR_BLACK, COLOR_TEAL, COLOR_DEEP_BLUE, COLOR_WHITE,
+    /* Sprite palette 3 - HUD digits in SPRITE_HUD builds */
+    COLOR_BLACK, COLOR_WHITE, COLOR_WHITE, COLOR_WHITE
+};
 
 /* Initialize NES hardware */
 void init_nes(void) {
@@ -131,61 +174,20 @@ void init_nes(void) {
     PPU_CTRL = 0;
     PPU_MASK = 0;
 
-    /* Initialize palette */
-    PPU_STATUS;
-    PPU_ADDR = 0x3F;
-    PPU_ADDR = 0x00;
-
-    /* Background palette 0 - will be set dynamically by set_bg_color */
-    PPU_DATA = COLOR_BLACK;       /* Universal background color */
-    PPU_DATA = COLOR_WHITE;       /* Text color */
-    PPU_DATA = COLOR_GRAY;        /* Color 2 */
-    PPU_DATA = COLOR_DARK_GRAY;   /* Color 3 */
-
-    /* Background palette 1 */
-    PPU_DATA = COLOR_BLACK;
-    PPU_DATA = COLOR_RED;
-    PPU_DATA = COLOR_YELLOW;
-    PPU_DATA = COLOR_GREEN;
-
-    /* Background palette 2 */
-    PPU_DATA = COLOR_BLACK;
-    PPU_DATA = COLOR_MAGENTA;
-    PPU_DATA = COLOR_ORANGE;
-    PPU_DATA = COLOR_TEAL;
+#ifdef CHR_RAM
+    /* Tiles into CHR-RAM before anything is drawn */
+    chr_unpack();
+#endif
 
-    /* Background palette 3 - for title screen text */
-    PPU_DATA = COLOR_BLACK;
-    PPU_DATA = COLOR_TEAL;      /* Cyan text */
-    PPU_DATA = COLOR_WHITE;
-    PPU_DATA = COLOR_BLUE;
+    /* Time a frame while nothing else runs: picks periods and tempo */
+    region_detect();
 
-    /* Sprite palette 0 - Blocks 1-3 (Magenta, Red, Orange) */
-    PPU_DATA = COLOR_BLACK;
-    PPU_DATA = COLOR_MAGENTA;
-    PPU_DATA = COLOR_RED;
-    PPU_DATA = COLOR_ORANGE;
+    /* Initialize palette: one 32-byte burst from the shadow */
+    palette_load(boot_palette);
+    palette_upload();
 
-    /* Sprite palette 1 - Blocks 4-6 (Yellow, Yellow-Green, Green) */
-    PPU_DATA = COLOR_BLACK;
-    PPU_DATA = COLOR_YELLOW;
-    PPU_DATA = COLOR_YELLOW_GREEN;
-    PPU_DATA = COLOR_GREEN;
-
-    /* Sprite palette 2 - Blocks 7-8 (Teal, Deep Blue) */
-    PPU_DATA = COLOR_BLACK;
-    PPU_DATA = COLOR_TEAL;
-    PPU_DATA = COLOR_DEEP_BLUE;
-    PPU_DATA = COLOR_WHITE;
-
-    /* Sprite palette 3 - Unused */
-    PPU_DATA = COLOR_BLACK;
-    PPU_DATA = COLOR_WHITE;
-    PPU_DATA = COLOR_WHITE;
-    PPU_DATA = COLOR_WHITE;
-
-    /* Clear any previous screen data (fixes soft reset residue) */
-    clear_screen();
+    /* No nametable clear here: the first screen (title, resumed game or
+     * benchmark) writes every nametable and attribute byte itself. */
 
     /* Reset scroll position */
     PPU_STATUS;
@@ -196,85 +198,94 @@ void init_nes(void) {
     PPU_CTRL = PPU_CTRL_NMI;
 }
 
-/* Display title screen */
-void show_title_screen(void) {
-    unsigned int addr;
-    unsigned char i;
-    unsigned char pass;
+/* Queue the title options: peg count or race above "PRESS START", practice below */
+static void show_title_options(void) {
+    if (race_mode) {
+        text_queue(13, 24, str_race);
+    } else {
+        vram_put(TEXT_ADDR(13, 24), (unsigned char)(0x10 + peg_mode));
+        text_queue(14, 24, str_pegs);
+    }
+    text_queue(12, 28, practice_mode ? str_practice : str_practice_blank);
+}
 
-    /* Set pink background for title screen */
-    set_bg_color(COLOR_PINK);
+/* Title words: big glyphs centered, 6 tiles per letter (5 + 1 gap) */
+typedef struct {
+    unsigned char y;
+    unsigned char x;
+    unsigned char len;
+    const unsigned char* glyphs;
+} title_word_t;
+
+static const unsigned char tower_glyphs[] = {BIG_T, BIG_O, BIG_W, BIG_E, BIG_R};
+static const unsigned char of_glyphs[] = {BIG_O, BIG_F};
+static const unsigned char hanoi_glyphs[] = {BIG_H, BIG_A, BIG_N, BIG_O, BIG_I};
+
+static const title_word_t title_words[] = {
+    {4, (32 - (5 * 6 - 1)) / 2, 5, tower_glyphs},
+    {11, (32 - (2 * 6 - 1)) / 2, 2, of_glyphs},
+    {18, (32 - (5 * 6 - 1)) / 2, 5, hanoi_glyphs}
+};
 
-    /* Disable rendering for PPU writes */
-    PPU_MASK = 0;
-    PPU_CTRL = 0;
+#define TITLE_PROMPT_ROW 26
+#define TITLE_PROMPT_X 10
 
-    /* Wait for vblank to avoid any emulator/PPU edge cases around VRAM writes */
-    while (!(PPU_STATUS & PPU_STATUS_VBLANK)) {
-    }
+/* Draw the title in one pass with rendering off: each nametable row is built
+ * in RAM and sent as part of a single 1024-byte stream from $2000 (attributes
+ * all palette 0, so the big title renders all-white), then the pink
+ * background color. Every byte is written once; nothing is cleared first. */
+static void draw_title_screen(void) {
+    static unsigned char row_tiles[32];
+    const title_word_t* word;
+    unsigned char y, x, w, g, c, bits;
+
+    /* NMI off: the stream takes longer than a frame, and crt0's NMI would
+     * reset the PPU address halfway through it */
+    PPU_CTRL = 0;
 
-    /* Clear nametable */
     PPU_STATUS;
     PPU_ADDR = 0x20;
     PPU_ADDR = 0x00;
-    for (i = 0; i < 240; i++) {
-        PPU_DATA = 0x00;
-        PPU_DATA = 0x00;
-        PPU_DATA = 0x00;
-        PPU_DATA = 0x00;
+    for (y = 0; y < 30; y++) {
+        for (x = 0; x < 32; x++) {
+            row_tiles[x] = 0x00;
+        }
+        for (w = 0; w < sizeof(title_words) / sizeof(title_words[0]); w++) {
+            word = &title_words[w];
+            if ((unsigned char)(y - word->y) >= 5) {
+                continue;
+            }
+            x = word->x;
+            for (g = 0; g < word->len; g++) {
+                bits = big_font[word->glyphs[g]][y - word->y];
+                for (c = 0; c < 5; c++) {
+                    if (bits & 0x10) {
+                        row_tiles[x + c] = 0x08;  /* Solid tile using palette color 1 */
+                    }
+                    bits <<= 1;
+                }
+                x += 6;
+            }
+        }
+        if (y == TITLE_PROMPT_ROW) {
+            for (x = 0; x < STR_PRESS_START_LEN; x++) {
+                row_tiles[TITLE_PROMPT_X + x] = str_press_start[x + 1];
+            }
+        }
+        for (x = 0; x < 32; x++) {
+            PPU_DATA = row_tiles[x];
+        }
     }
-
-    /* Clear attribute table (we'll set it after drawing) */
-    for (i = 0; i < 64; i++) {
+    for (x = 0; x < 64; x++) {
         PPU_DATA = 0x00;
     }
 
-    /* Draw large title and prompt. Draw twice as a robustness workaround against dropped VRAM writes. */
-    for (pass = 0; pass < 2; pass++) {
-        static const unsigned char tower_glyphs[] = {BIG_T, BIG_O, BIG_W, BIG_E, BIG_R};
-        static const unsigned char of_glyphs[] = {BIG_O, BIG_F};
-        static const unsigned char hanoi_glyphs[] = {BIG_H, BIG_A, BIG_N, BIG_O, BIG_I};
-
-        /* Word widths in tiles: len*5 + (len-1)*1 */
-        unsigned char tower_w = (unsigned char)(5 * 5 + 4);
-        unsigned char of_w = (unsigned char)(2 * 5 + 1);
-        unsigned char hanoi_w = (unsigned char)(5 * 5 + 4);
-
-        unsigned char tower_x = (unsigned char)((32 - tower_w) / 2);
-        unsigned char of_x = (unsigned char)((32 - of_w) / 2);
-        unsigned char hanoi_x = (unsigned char)((32 - hanoi_w) / 2);
-
-        draw_big_word(tower_x, 4, tower_glyphs, 5);
-        draw_big_word(of_x, 11, of_glyphs, 2);
-        draw_big_word(hanoi_x, 18, hanoi_glyphs, 5);
-
-        /* Write "PRESS START" below the title (manual write; keep rendering disabled) */
-        addr = 0x2000 + (26 * 32) + 10;
-        PPU_STATUS;
-        PPU_ADDR = (unsigned char)(addr >> 8);
-        PPU_ADDR = (unsigned char)(addr & 0xFF);
-        PPU_DATA = 0x50; /* P */
-        PPU_DATA = 0x52; /* R */
-        PPU_DATA = 0x45; /* E */
-        PPU_DATA = 0x53; /* S */
-        PPU_DATA = 0x53; /* S */
-        PPU_DATA = 0x00; /* space */
-        PPU_DATA = 0x53; /* S */
-        PPU_DATA = 0x54; /* T */
-        PPU_DATA = 0x41; /* A */
-        PPU_DATA = 0x52; /* R */
-        PPU_DATA = 0x54; /* T */
-    }
-
-    /* Set attribute table to use palette 0 so the big title renders all-white */
-    PPU_MASK = 0;
-    addr = 0x23C0;
-    PPU_STATUS;
-    PPU_ADDR = (unsigned char)(addr >> 8);
-    PPU_ADDR = (unsigned char)(addr & 0xFF);
-    for (i = 0; i < 64; i++) {
-        PPU_DATA = 0x00;
-    }
+    /* Pink background for the title screen; palette and options go out
+     * before rendering starts, so the first frame shown is complete */
+    palette_set_bg(COLOR_PINK);
+    palette_upload();
+    show_title_options();
+    vram_flush();
 
     /* Reset scroll and enable rendering */
     PPU_STATUS;
@@ -284,281 +295,526 @@ void show_title_screen(void) {
     PPU_MASK = PPU_MASK_SHOW_BG;
 }
 
-/* Display level complete screen */
-void show_level_complete(void) {
-    unsigned int addr;
+/* Display title screen */
+void show_title_screen(void) {
+    /* Disable rendering for PPU writes */
+    PPU_MASK = 0;
+    PPU_CTRL = 0;
+
+    /* Wait for vblank to avoid any emulator/PPU edge cases around VRAM writes */
+    while (!(PPU_STATUS & PPU_STATUS_VBLANK)) {
+    }
+
+    palette_effect(PALETTE_FADE_IN, 0);
+    telemetry_resync();
+    draw_title_screen();
+}
+
+/* Display level complete screen ("BEST!" when a frame record fell) */
+void show_level_complete(unsigned char new_best) {
+    static const unsigned char nice_attrs[] = {
+        0xAA, 0xAA  /* palette 2 for all quadrants */
+    };
 
     /* Overlay "NICE!" on top of the existing gameplay screen (no clear). */
-    addr = 0x2000 + (6 * 32) + 14;
-    PPU_STATUS;
-    PPU_ADDR = (unsigned char)(addr >> 8);
-    PPU_ADDR = (unsigned char)(addr & 0xFF);
-    PPU_DATA = 0x4E; /* N */
-    PPU_DATA = 0x49; /* I */
-    PPU_DATA = 0x43; /* C */
-    PPU_DATA = 0x45; /* E */
-    PPU_DATA = 0x21; /* ! */
+    text_queue(14, 6, new_best ? str_best : str_nice);
 
     /*
      * Make the overlay use background palette 2 so it shows up in bright pink/magenta.
      * "NICE!" spans attribute columns 3-4 on attribute row 1 (tile Y=6).
      */
-    addr = 0x23C0 + (1 * 8) + 3;
-    PPU_STATUS;
-    PPU_ADDR = (unsigned char)(addr >> 8);
-    PPU_ADDR = (unsigned char)(addr & 0xFF);
-    PPU_DATA = 0xAA; /* palette 2 for all quadrants */
-    PPU_DATA = 0xAA; /* next attribute byte */
+    vram_write(0x23C0 + (1 * 8) + 3, nice_attrs, sizeof(nice_attrs));
+}
 
+/* Finish a text screen drawn with rendering off: fade in, scroll home, no sprites */
+static void end_text_screen(void) {
+    telemetry_resync();
+    palette_effect(PALETTE_FADE_IN, 0);
+    palette_upload();
     PPU_STATUS;
     PPU_SCROLL = 0;
     PPU_SCROLL = 0;
+    PPU_CTRL = PPU_CTRL_NMI;
+    PPU_MASK = PPU_MASK_SHOW_BG;
+    clear_sprites();
+    update_sprites();
 }
 
 /* Display life lost screen (used when giving up via Select). */
 void show_life_lost(void) {
     clear_screen();
 
-    write_text(12, 10, "LIFE LOST");
+    text_draw(12, 10, str_life_lost);
 
-    PPU_CTRL = PPU_CTRL_NMI;
-    PPU_MASK = PPU_MASK_SHOW_BG;
-    clear_sprites();
-    update_sprites();
+    end_text_screen();
 }
 
 /* Display failed level screen */
 void show_level_failed(void) {
     clear_screen();
 
-    write_text(9, 8, "TOO MANY MOVES");
-    write_text(10, 10, "LIFE LOST");
-    write_text(7, 14, "PRESS START");
+    text_draw(9, 8, str_too_many_moves);
+    text_draw(10, 10, str_life_lost);
+    text_draw(7, 14, str_press_start);
 
-    PPU_CTRL = PPU_CTRL_NMI;
-    PPU_MASK = PPU_MASK_SHOW_BG;
-    clear_sprites();
-    update_sprites();
+    end_text_screen();
 }
 
 /* Display game over screen */
 void show_game_over(void) {
     clear_screen();
 
-    write_text(10, 10, "GAME OVER");
-    write_text(7, 14, "PRESS START");
+    text_draw(10, 10, str_game_over);
+    text_draw(7, 14, str_press_start);
 
-    PPU_CTRL = PPU_CTRL_NMI;
-    PPU_MASK = PPU_MASK_SHOW_BG;
-    clear_sprites();
-    update_sprites();
+    end_text_screen();
 }
 
 /* Display win screen */
 void show_win_screen(void) {
+    unsigned char tiles[SPEEDRUN_TEXT_LEN];
+    unsigned char level;
+    unsigned char row;
+
     clear_screen();
 
-    write_text(9, 8, "YOU WIN");
-    write_text(6, 12, "ALL LEVELS COMPLETE");
-    write_text(7, 16, "PRESS START");
+    text_draw(9, 3, str_you_win);
+    text_draw(6, 5, str_all_levels_complete);
+    if (speedrun_resumed) {
+        text_draw(7, 7, str_timed_from_resume);
+    }
 
-    PPU_CTRL = PPU_CTRL_NMI;
-    PPU_MASK = PPU_MASK_SHOW_BG;
-    clear_sprites();
-    update_sprites();
+    /* Splits: run time at each level clear; the last one is the final time */
+    for (level = 1; level <= MAX_BLOCKS; level++) {
+        row = 7 + level * 2;
+        text_draw(7, row, str_level);
+        tiles[0] = 0x10 + level;
+        text_draw_tiles(13, row, tiles, 1);
+        if (speedrun_splits[level - 1][SPEEDRUN_MINUTES] != SPEEDRUN_NO_SPLIT) {
+            speedrun_format(tiles, speedrun_splits[level - 1]);
+            text_draw_tiles(16, row, tiles, SPEEDRUN_TEXT_LEN);
+        }
+    }
+
+    text_draw(7, 26, str_press_start);
+
+    end_text_screen();
 }
 
-/* Wait for vblank */
+/* Wait for vblank, keeping the spare time for telemetry */
 void wait_vblank(void) {
-    while (!(PPU_STATUS & PPU_STATUS_VBLANK));
+    telemetry_idle = frame_idle();
+}
+
+/* Return to the gameplay screen for the current level */
+static void resume_gameplay(void) {
+    game_state = STATE_GAMEPLAY;
+    replay_wait = 0;
+    save_snapshot(&hanoi_game, STATE_GAMEPLAY);
+    palette_set_bg(COLOR_LIGHT_BLUE);
+    needs_bg_redraw = 1;
+}
+
+/* Timer callback: leave STATE_LIFE_LOST (level was already reset) */
+static void end_life_lost(void) {
+    transition_timer = SCHED_NONE;
+    if (hanoi_game.lives == 0) {
+        game_state = STATE_GAME_OVER;
+        speedrun_running = 0;
+        stop_music();
+        show_game_over();
+    } else {
+        resume_gameplay();
+    }
+}
+
+/* Timer callback: leave STATE_LEVEL_FAILED (level was already reset) */
+static void end_level_failed(void) {
+    transition_timer = SCHED_NONE;
+    resume_gameplay();
+}
+
+/* Timer callback: leave STATE_LEVEL_COMPLETE */
+static void end_level_complete(void) {
+    transition_timer = SCHED_NONE;
+    hanoi_game.level++;
+    hanoi_game.first_try = 1;
+    start_level(&hanoi_game);
+    game_state = STATE_GAMEPLAY;
+    replay_wait = 0;
+    save_snapshot(&hanoi_game, STATE_GAMEPLAY);
+    needs_bg_redraw = 1;
+}
+
+/* Timer callback: a transition's time is nearly up; fade out, then leave */
+static void fade_out_transition(void) {
+    transition_timer = SCHED_NONE;
+    palette_effect(PALETTE_FADE_OUT, transition_done);
+}
+
+/* Enter a timed transition state; its callback runs after the timeout,
+ * the last PALETTE_FADE_FRAMES of which are a fade-out */
+static void begin_transition(unsigned char state, unsigned char frames, sched_callback_t done) {
+    sched_cancel(transition_timer);
+    game_state = state;
+    transition_done = done;
+    transition_timer = sched_after(frames - PALETTE_FADE_FRAMES, fade_out_transition);
+}
+
+/* Cut a running transition short (Start/A), fade-out or not */
+static void skip_transition(sched_callback_t done) {
+    sched_cancel(transition_timer);
+    palette_cancel();
+    done();
+}
+
+/*
+ * Apply one frame's worth of button presses to the puzzle. Every edge in
+ * the mask is handled, in this order:
+ *   Select (give up; ends the level, later edges are dropped),
+ *   in practice mode Start (replay), Up (undo) or Down (redo), each ending
+ *   the frame's handling,
+ *   Left, Right, A (pick up / place), B (cancel).
+ * so A pressed together with a direction acts on the newly selected tower.
+ * Returns 0 once the game has left STATE_GAMEPLAY.
+ */
+static unsigned char handle_gameplay_input(unsigned char pressed) {
+    unsigned char win_status;
+    unsigned char tower;
+
+    if (pressed & BUTTON_SELECT) {
+        /* Give up on this level: show LIFE LOST and restart after a brief pause */
+        play_sfx_fail();
+        if (hanoi_game.lives > 0) {
+            hanoi_game.lives--;
+        }
+        hanoi_game.first_try = 0;
+        hanoi_game.streak = 0;
+        /* The life is gone now: a reset during the pause must not restore it */
+        if (hanoi_game.lives == 0) {
+            save_clear_snapshot();
+        } else {
+            start_level(&hanoi_game);
+            save_snapshot(&hanoi_game, STATE_GAMEPLAY);
+        }
+        show_life_lost();
+        begin_transition(STATE_LIFE_LOST, LIFE_LOST_FRAMES, end_life_lost);
+        return 0;
+    }
+
+    if (hanoi_game.practice) {
+        if (pressed & BUTTON_START) {
+            /* Replay the level so far from the start; Start again stops it */
+            if (replay_wait) {
+                replay_wait = 0;
+            } else if (replay_start(&hanoi_game)) {
+                replay_wait = REPLAY_FRAMES;
+                needs_hud_redraw = 1;
+                needs_sprite_rebuild = 1;
+            }
+            return 1;
+        }
+        if (replay_wait) {
+            return 1;  /* The replay owns the board */
+        }
+        if (((pressed & BUTTON_UP) && undo_move(&hanoi_game)) ||
+            ((pressed & BUTTON_DOWN) && redo_move(&hanoi_game))) {
+            needs_hud_redraw = 1;
+            needs_sprite_rebuild = 1;
+            save_snapshot(&hanoi_game, STATE_GAMEPLAY);
+            return 1;
+        }
+    }
+
+    tower = hanoi_game.selected_tower;
+    if (pressed & BUTTON_LEFT) {
+        if (hanoi_game.selected_tower > 0) {
+            hanoi_game.selected_tower--;
+            needs_sprite_rebuild = 1;
+        }
+    }
+    if (pressed & BUTTON_RIGHT) {
+        if (hanoi_game.selected_tower < hanoi_game.num_towers - 1) {
+            hanoi_game.selected_tower++;
+            needs_sprite_rebuild = 1;
+        }
+    }
+    if (hanoi_game.holding_block != 0 && tower != hanoi_game.selected_tower) {
+        anim_slide(tower, hanoi_game.selected_tower);
+    }
+
+    tower = hanoi_game.selected_tower;
+    if (pressed & BUTTON_A) {
+        if (hanoi_game.holding_block == 0) {
+            /* Try to pick up a block */
+            if (pickup_block(&hanoi_game, tower)) {
+                anim_pickup(hanoi_game.holding_block, tower, hanoi_game.tower_heights[tower]);
+            }
+            needs_sprite_rebuild = 1;
+        } else if (place_block(&hanoi_game, tower)) {
+            anim_place(tower, hanoi_game.tower_heights[tower] - 1);
+            needs_hud_redraw = 1;
+            needs_sprite_rebuild = 1;
+            /* Check for win */
+            win_status = check_win(&hanoi_game);
+            if (win_status == 1) {
+                /* Perfect win */
+                play_sfx_success();
+                if (hanoi_game.first_try) {
+                    hanoi_game.streak++;
+                }
+                /* Practice runs can undo, so they never set records */
+                level_new_best = hanoi_game.practice ? 0 : (save_record_level(&hanoi_game) & SAVE_NEW_FRAMES);
+                save_export_movelog(&hanoi_game);
+                if (hanoi_game.level_frames != SAVE_NO_FRAMES) {
+                    telemetry_level(hanoi_game.level, hanoi_game.level_frames);
+                }
+                speedrun_split(hanoi_game.level);
+                if (hanoi_game.level >= 8) {
+                    game_state = STATE_WIN_GAME;
+                    save_clear_snapshot();
+                    speedrun_running = 0;
+                    stop_music();
+                    show_win_screen();
+                } else {
+                    begin_transition(STATE_LEVEL_COMPLETE, LEVEL_COMPLETE_FRAMES, end_level_complete);
+                    palette_effect(PALETTE_FLASH, 0);
+                    needs_nice_overlay = 1;
+                    needs_sprite_rebuild = 1; /* hide cursor during overlay */
+                }
+                return 0;
+            } else if (win_status == 2) {
+                /* Complete but not optimal - lose a life */
+                play_sfx_fail();
+                hanoi_game.lives--;
+                hanoi_game.first_try = 0;
+                hanoi_game.streak = 0;
+                if (hanoi_game.lives == 0) {
+                    game_state = STATE_GAME_OVER;
+                    save_clear_snapshot();
+                    speedrun_running = 0;
+                    stop_music();
+                    show_game_over();
+                } else {
+                    show_level_failed();
+                    start_level(&hanoi_game);
+                    save_snapshot(&hanoi_game, STATE_GAMEPLAY);
+                    /* Brief pause then re-render */
+                    begin_transition(STATE_LEVEL_FAILED, LEVEL_FAILED_FRAMES, end_level_failed);
+                }
+                return 0;
+            }
+            /* Completed move: this is the position a reset resumes from */
+            save_snapshot(&hanoi_game, STATE_GAMEPLAY);
+        }
+    }
+
+    if (pressed & BUTTON_B) {
+        /* Cancel - put block back */
+        if (hanoi_game.holding_block != 0) {
+            place_block(&hanoi_game, hanoi_game.holding_from);
+            anim_return(tower, hanoi_game.holding_from,
+                        hanoi_game.tower_heights[hanoi_game.holding_from] - 1);
+            needs_hud_redraw = 1;
+            needs_sprite_rebuild = 1;
+        }
+    }
+
+    return 1;
 }
 
 /* Main function */
 void main(void) {
-    unsigned char win_status;
+    unsigned char pressed;
+    unsigned char moved;
+    unsigned char redrawn;
+    unsigned char resume_pegs[MAX_BLOCKS];
 
     /* Initialize hardware */
     init_nes();
     init_music();
     init_sfx();
+    sched_init();
+    save_init();
+    telemetry_init();
+
+#ifdef SELFBENCH
+    /* Benchmark build: no title, solve every level, show the figures */
+    selfbench_run();
+#endif
 
     /* Initialize game state */
     game_state = STATE_TITLE;
     frame_counter = 0;
+    transition_timer = SCHED_NONE;
     needs_bg_redraw = 0;
     needs_hud_redraw = 0;
     needs_sprite_rebuild = 0;
+    sprites_crowded = 0;
     needs_nice_overlay = 0;
-
-    /* Show title screen */
-    show_title_screen();
-    play_song(SONG_JINGLE_BELLS);
+    level_new_best = 0;
+    peg_mode = MIN_TOWERS;
+    practice_mode = 0;
+    race_mode = 0;
+    replay_wait = 0;
+
+    if (save_load_snapshot(&hanoi_game, resume_pegs) == STATE_GAMEPLAY) {
+        /* Resume the interrupted game: one background build, no title */
+        resume_game(&hanoi_game, resume_pegs);
+        peg_mode = hanoi_game.num_towers;
+        practice_mode = hanoi_game.practice;
+        speedrun_resume(hanoi_game.level);
+        game_state = STATE_GAMEPLAY;
+        play_song(SONG_ODE_TO_JOY);
+        palette_set_bg(COLOR_LIGHT_BLUE);
+        needs_bg_redraw = 1;
+    } else {
+        /* Title straight away: init_nes left rendering off */
+        draw_title_screen();
+        play_song(SONG_JINGLE_BELLS);
+    }
     clear_sprites();
     update_sprites();
 
     /* Main game loop */
     while (1) {
-        /* Wait for vblank and perform PPU updates first to avoid visible artifacts */
+        /* Vblank: upload only what the previous pass prepared */
         wait_vblank();
-
-        if (game_state == STATE_GAMEPLAY || game_state == STATE_LEVEL_COMPLETE) {
-            if (needs_bg_redraw) {
-                render_game_background(&hanoi_game);
-                needs_bg_redraw = 0;
-                needs_hud_redraw = 0;
-                needs_sprite_rebuild = 1;
-            }
-            if (needs_hud_redraw) {
-                render_game_hud(&hanoi_game);
-                needs_hud_redraw = 0;
-            }
-            if (needs_nice_overlay) {
-                show_level_complete();
-                needs_nice_overlay = 0;
-            }
-            if (needs_sprite_rebuild) {
-                build_game_sprites(&hanoi_game, (game_state == STATE_GAMEPLAY));
-                needs_sprite_rebuild = 0;
-            }
-            update_sprites();
+        update_sprites();
+        palette_upload();
+        vram_flush();
+        PPU_CTRL = PPU_CTRL_NMI;  /* HUD shows nametable $2000 at 0,0 */
+
+        /* Full redraws run with rendering off, right after vblank */
+        redrawn = 0;
+        if ((game_state == STATE_GAMEPLAY || game_state == STATE_LEVEL_COMPLETE) && needs_bg_redraw) {
+            palette_effect(PALETTE_FADE_IN, 0);
+            telemetry_resync();
+            render_game_background(&hanoi_game);
+            needs_bg_redraw = 0;
+            needs_hud_redraw = 0;
+            needs_sprite_rebuild = 1;
+            redrawn = 1;
         }
 
-        /* Update audio once per frame */
+        /* Update audio once per frame; on 50 Hz every ~5th frame is 2 ticks */
+        region_tick();
         update_music();
         update_sfx();
         frame_counter++;
+        telemetry_update();
+#ifdef CHR_RAM
+        chr_shimmer_step();
+#endif
+
+        /* Scroll the playfield below the HUD once sprite 0 is on screen */
+        if ((game_state == STATE_GAMEPLAY || game_state == STATE_LEVEL_COMPLETE) && !redrawn &&
+            oam_buffer[SPRITE0_SLOT].y != 0xFF) {
+            split_scroll(playfield_scroll);
+        }
 
-        /* Read controller input */
-        read_controller();
+        /* Advance timers; transitions end from here, never from a busy-wait */
+        sched_update();
+        palette_step();
+        speedrun_tick();
+
+        /* Read controller input; a race reads every pad */
+        if (game_state == STATE_RACE) {
+            read_pads();
+        } else {
+            read_controller();
+        }
 
         switch (game_state) {
             case STATE_TITLE:
+                /* Select cycles classic 3 pegs / Reve's puzzle 4 pegs / race */
+                if (button_pressed(BUTTON_SELECT)) {
+                    if (race_mode) {
+                        race_mode = 0;
+                        peg_mode = MIN_TOWERS;
+                    } else if (peg_mode == MAX_TOWERS) {
+                        race_mode = 1;
+                    } else {
+                        peg_mode = MAX_TOWERS;
+                    }
+                    show_title_options();
+                }
+                /* B toggles practice mode */
+                if (button_pressed(BUTTON_B)) {
+                    practice_mode = !practice_mode;
+                    show_title_options();
+                }
                 /* Wait for start button */
-                if (button_pressed(BUTTON_START)) {
-                    init_game(&hanoi_game);
+                if (button_pressed(BUTTON_START) && race_mode) {
+                    game_state = STATE_RACE;
+                    stop_music();
+                    play_song(SONG_ODE_TO_JOY);
+                    palette_set_bg(COLOR_LIGHT_BLUE);
+                    palette_effect(PALETTE_FADE_IN, 0);
+                    telemetry_resync();
+                    race_start();
+                } else if (button_pressed(BUTTON_START)) {
+                    init_game(&hanoi_game, peg_mode);
+                    hanoi_game.practice = practice_mode;
+                    replay_wait = 0;
+                    save_snapshot(&hanoi_game, STATE_GAMEPLAY);
+                    speedrun_start();
+                    input_buffer_clear();
                     game_state = STATE_GAMEPLAY;
                     stop_music();
                     play_song(SONG_ODE_TO_JOY);
                     /* Set light blue background for gameplay */
-                    set_bg_color(COLOR_LIGHT_BLUE);
+                    palette_set_bg(COLOR_LIGHT_BLUE);
                     needs_bg_redraw = 1;
                 }
                 break;
 
             case STATE_GAMEPLAY:
-                /* Handle gameplay input */
-                if (button_pressed(BUTTON_LEFT)) {
-                    if (hanoi_game.selected_tower > 0) {
-                        hanoi_game.selected_tower--;
-                        needs_sprite_rebuild = 1;
-                    }
+                if (needs_bg_redraw) {
+                    /* Screen is not up yet; keep presses for the first playable frame */
+                    input_buffer_store();
+                    break;
                 }
-                else if (button_pressed(BUTTON_RIGHT)) {
-                    if (hanoi_game.selected_tower < NUM_TOWERS - 1) {
-                        hanoi_game.selected_tower++;
-                        needs_sprite_rebuild = 1;
-                    }
+                if (hanoi_game.level_frames != SAVE_NO_FRAMES) {
+                    hanoi_game.level_frames++;
                 }
-                else if (button_pressed(BUTTON_SELECT)) {
-                    /* Give up on this level: show LIFE LOST and restart after a brief pause */
-                    play_sfx_fail();
-                    if (hanoi_game.lives > 0) {
-                        hanoi_game.lives--;
-                    }
-                    if (hanoi_game.lives == 0) {
-                        show_life_lost();
-                        for (win_status = 0; win_status < 120; win_status++) {
-                            wait_vblank();
-                        }
-                        game_state = STATE_GAME_OVER;
-                        stop_music();
-                        show_game_over();
-                    } else {
-                        show_life_lost();
-                        start_level(&hanoi_game);
-                        for (win_status = 0; win_status < 120; win_status++) {
-                            wait_vblank();
-                        }
-                        set_bg_color(COLOR_LIGHT_BLUE);
-                        needs_bg_redraw = 1;
-                    }
+                /* Replay: one logged move every REPLAY_FRAMES, every frame while A is held */
+                if (replay_wait && (--replay_wait == 0 || (controller1 & BUTTON_A))) {
+                    replay_wait = redo_move(&hanoi_game) ? REPLAY_FRAMES : 0;
+                    needs_hud_redraw = 1;
+                    needs_sprite_rebuild = 1;
                 }
-                else if (button_pressed(BUTTON_A)) {
-                    unsigned char should_render = 1;
-                    if (hanoi_game.holding_block == 0) {
-                        /* Try to pick up a block */
-                        pickup_block(&hanoi_game, hanoi_game.selected_tower);
-                        needs_sprite_rebuild = 1;
-                    } else {
-                        /* Try to place the block */
-                        if (place_block(&hanoi_game, hanoi_game.selected_tower)) {
-                            needs_hud_redraw = 1;
-                            needs_sprite_rebuild = 1;
-                            /* Check for win */
-                            win_status = check_win(&hanoi_game);
-                            if (win_status == 1) {
-                                /* Perfect win */
-                                play_sfx_success();
-                                if (hanoi_game.level >= 8) {
-                                    game_state = STATE_WIN_GAME;
-                                    stop_music();
-                                    show_win_screen();
-                                    should_render = 0;
-                                } else {
-                                    game_state = STATE_LEVEL_COMPLETE;
-                                    level_complete_timer = 120;  /* 2 seconds at 60 FPS */
-                                    needs_nice_overlay = 1;
-                                    needs_sprite_rebuild = 1; /* hide cursor during overlay */
-                                    should_render = 0;
-                                }
-                            } else if (win_status == 2) {
-                                /* Complete but not optimal - lose a life */
-                                play_sfx_fail();
-                                hanoi_game.lives--;
-                                if (hanoi_game.lives == 0) {
-                                    game_state = STATE_GAME_OVER;
-                                    stop_music();
-                                    show_game_over();
-                                    should_render = 0;
-                                } else {
-                                    show_level_failed();
-                                    start_level(&hanoi_game);
-                                    /* Brief pause then re-render */
-                                    for (win_status = 0; win_status < 120; win_status++) {
-                                        wait_vblank();
-                                    }
-                                    game_state = STATE_GAMEPLAY;
-                                    set_bg_color(COLOR_LIGHT_BLUE);
-                                    needs_bg_redraw = 1;
-                                    should_render = 0;
-                                }
-                            }
-                        }
-                    }
-                    if (should_render) {
-                        /* No full redraw needed; sprites/HUD are updated during vblank. */
+                /* Replay presses buffered during transitions, then this frame's */
+                for (pressed = input_buffer_pop(); pressed != 0; pressed = input_buffer_pop()) {
+                    if (!handle_gameplay_input(pressed)) {
+                        break;
                     }
                 }
-                else if (button_pressed(BUTTON_B)) {
-                    /* Cancel - put block back */
-                    if (hanoi_game.holding_block != 0) {
-                        place_block(&hanoi_game, hanoi_game.holding_from);
-                        hanoi_game.moves--;  /* Don't count this as a move */
-                        needs_hud_redraw = 1;
-                        needs_sprite_rebuild = 1;
-                    }
+                if (game_state == STATE_GAMEPLAY) {
+                    handle_gameplay_input(controller1_pressed);
                 }
                 break;
 
             case STATE_LEVEL_COMPLETE:
-                /* Auto-proceed after timer, or immediately on Start/A button */
-                if (button_pressed(BUTTON_START) || button_pressed(BUTTON_A) || level_complete_timer == 0) {
-                    hanoi_game.level++;
-                    start_level(&hanoi_game);
-                    game_state = STATE_GAMEPLAY;
-                    needs_bg_redraw = 1;
+                /* Auto-proceeds when the timer fires, or immediately on Start/A button */
+                if (button_pressed(BUTTON_START) || button_pressed(BUTTON_A)) {
+                    skip_transition(end_level_complete);
                 } else {
-                    level_complete_timer--;
+                    input_buffer_store();
+                }
+                break;
+
+            case STATE_LIFE_LOST:
+                /* Timed pause; the scheduler ends it */
+                input_buffer_store();
+                break;
+
+            case STATE_LEVEL_FAILED:
+                /* Auto-proceeds when the timer fires, or immediately on Start */
+                if (button_pressed(BUTTON_START)) {
+                    skip_transition(end_level_failed);
+                } else {
+                    input_buffer_store();
                 }
                 break;
 
@@ -573,6 +829,17 @@ void main(void) {
                 }
                 break;
 
+            case STATE_RACE:
+                /* The race runs itself; Start after the finish returns to the title */
+                if (!race_update()) {
+                    game_state = STATE_TITLE;
+                    show_title_screen();
+                    play_song(SONG_JINGLE_BELLS);
+                    clear_sprites();
+                    update_sprites();
+                }
+                break;
+
             case STATE_WIN_GAME:
                 /* Wait for start to return to title */
                 if (button_pressed(BUTTON_START)) {
@@ -584,5 +851,37 @@ void main(void) {
                 }
                 break;
         }
+
+        /*
+         * Prepare the next frame from this frame's input: sprites go to
+         * oam_buffer and HUD/overlay tiles to the VRAM queue. Both are
+         * uploaded at the next vblank, so a press read this frame is on
+         * screen in the very next displayed frame.
+         */
+        if ((game_state == STATE_GAMEPLAY || game_state == STATE_LEVEL_COMPLETE) && !needs_bg_redraw) {
+            moved = anim_update();
+            if (region_ticks > 1) {
+                moved |= anim_update();  /* Motion tables are in ticks too */
+            }
+            if (update_camera(&hanoi_game)) {
+                needs_sprite_rebuild = 1;  /* Every sprite shifts with the playfield */
+            }
+            if (needs_hud_redraw) {
+                render_game_hud(&hanoi_game);
+                needs_hud_redraw = 0;
+            }
+            speedrun_queue_hud();
+            if (needs_nice_overlay) {
+                show_level_complete(level_new_best);
+                needs_nice_overlay = 0;
+            }
+            if (needs_sprite_rebuild || sprites_crowded) {
+                sprites_crowded = build_game_sprites(&hanoi_game, (game_state == STATE_GAMEPLAY));
+                needs_sprite_rebuild = 0;
+            } else if (moved) {
+                /* Only the disk in flight changed: move its sprites, nothing else */
+                draw_moving_block();
+            }
+        }
     }
 }
@@ -0,0 +1,39 @@
+#include "nes.h"
+#include "sprite.h"
+#include "metasprite.h"
+
+unsigned char metasprite_offscreen;
+
+void draw_metasprite(unsigned char x, unsigned char y, unsigned char id) {
+    const unsigned char* entry = &metasprite_data[metasprite_offset[id]];
+    unsigned char count = *entry++;
+    sprite_t* oam;
+    unsigned char dx;
+    unsigned char sx;
+    unsigned char wrapped;
+
+    if (count > sprite_pool_free) {
+        return;  /* Pool exhausted: drop the whole metasprite */
+    }
+    sprite_pool_free -= count;
+
+    for (; count != 0; count--) {
+        oam = &oam_buffer[sprite_pool_next];
+        dx = entry[0];
+        sx = x + dx;
+        /* Carry out of the 8-bit add means the sprite crossed a screen edge */
+        wrapped = (dx & 0x80) ? (sx > x) : (sx < x);
+        if (wrapped == metasprite_offscreen) {
+            oam->y = y + entry[1];
+            oam->x = sx;
+        } else {
+            oam->y = 0xFF;  /* Clipped */
+        }
+        oam->tile = entry[2];
+        oam->attributes = entry[3];
+        entry += 4;
+        if (++sprite_pool_next == sprite_pool_end) {
+            sprite_pool_next = sprite_pool_first;  /* Wrap inside the rotating ring */
+        }
+    }
+}
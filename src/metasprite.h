@@ -0,0 +1,25 @@
+#ifndef METASPRITE_H
+#define METASPRITE_H
+
+#include "metasprite_data.h"
+
+/*
+ * Metasprites: groups of OAM entries drawn from ROM tables
+ * (tools/gen_metasprites.py). Placement is two 8-bit adds per sprite.
+ * A metasprite always takes its full entry count in OAM; entries clipped
+ * at a screen edge are parked off-screen, so the slots a metasprite uses
+ * never depend on where it is. Slots come from the sprite pool (sprite.h).
+ */
+
+/* Set when x passed to draw_metasprite() is the low byte of a center that
+ * lies past the left or right screen edge (only wrapped entries show) */
+extern unsigned char metasprite_offscreen;
+
+/* Emit metasprite id centered at screen x, top row y; dropped whole if
+ * the pool is out of slots */
+void draw_metasprite(unsigned char x, unsigned char y, unsigned char id);
+
+/* Sprites a metasprite takes */
+#define metasprite_size(id) (metasprite_data[metasprite_offset[id]])
+
+#endif /* METASPRITE_H */
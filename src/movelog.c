@@ -0,0 +1,118 @@
+#include "hanoi.h"
+#include "movelog.h"
+
+unsigned char movelog_data[MOVELOG_BYTES + 1];
+unsigned char movelog_width;
+unsigned char movelog_start;
+unsigned char movelog_count;
+unsigned char movelog_total;
+unsigned char movelog_dropped;
+
+static unsigned char movelog_capacity;
+static unsigned char movelog_mask;
+static unsigned char movelog_pegs;
+
+/* Code -> packed move, ordered by source then destination */
+static const unsigned char movelog_decode3[6] = {
+    MOVE_PACK(0, 1), MOVE_PACK(0, 2), MOVE_PACK(1, 0),
+    MOVE_PACK(1, 2), MOVE_PACK(2, 0), MOVE_PACK(2, 1)
+};
+static const unsigned char movelog_decode4[12] = {
+    MOVE_PACK(0, 1), MOVE_PACK(0, 2), MOVE_PACK(0, 3),
+    MOVE_PACK(1, 0), MOVE_PACK(1, 2), MOVE_PACK(1, 3),
+    MOVE_PACK(2, 0), MOVE_PACK(2, 1), MOVE_PACK(2, 3),
+    MOVE_PACK(3, 0), MOVE_PACK(3, 1), MOVE_PACK(3, 2)
+};
+
+/* Ring slot n moves after the oldest */
+static unsigned char movelog_slot(unsigned char n) {
+    unsigned int slot = (unsigned int)movelog_start + n;
+
+    if (slot >= movelog_capacity) {
+        slot -= movelog_capacity;
+    }
+    return (unsigned char)slot;
+}
+
+static unsigned char movelog_get(unsigned char slot) {
+    unsigned int bit = (unsigned int)slot * movelog_width;
+    unsigned char index = (unsigned char)(bit >> 3);
+    unsigned int pair = movelog_data[index] | ((unsigned int)movelog_data[index + 1] << 8);
+
+    return (unsigned char)(pair >> (bit & 7)) & movelog_mask;
+}
+
+static void movelog_set(unsigned char slot, unsigned char code) {
+    unsigned int bit = (unsigned int)slot * movelog_width;
+    unsigned char index = (unsigned char)(bit >> 3);
+    unsigned char shift = (unsigned char)(bit & 7);
+    unsigned int pair = movelog_data[index] | ((unsigned int)movelog_data[index + 1] << 8);
+
+    pair &= ~((unsigned int)movelog_mask << shift);
+    pair |= (unsigned int)code << shift;
+    movelog_data[index] = (unsigned char)pair;
+    movelog_data[index + 1] = (unsigned char)(pair >> 8);
+}
+
+static unsigned char movelog_decode(unsigned char code) {
+    return (movelog_pegs == 4) ? movelog_decode4[code] : movelog_decode3[code];
+}
+
+void movelog_reset(unsigned char num_towers) {
+    movelog_pegs = num_towers;
+    if (num_towers == 4) {
+        movelog_width = 4;
+        movelog_capacity = (MOVELOG_BYTES * 8) / 4;
+    } else {
+        movelog_width = 3;
+        movelog_capacity = 255;  /* 256 would fit; counts are 8-bit */
+    }
+    movelog_mask = (unsigned char)((1 << movelog_width) - 1);
+    movelog_start = 0;
+    movelog_count = 0;
+    movelog_total = 0;
+    movelog_dropped = 0;
+}
+
+void movelog_push(unsigned char from, unsigned char to) {
+    /* code = from * (pegs - 1) + index of to among the other pegs */
+    unsigned char code = from + from + to - (to > from ? 1 : 0);
+
+    if (movelog_pegs == 4) {
+        code += from;
+    }
+
+    movelog_set(movelog_slot(movelog_count), code);
+    if (movelog_count == movelog_capacity) {
+        /* Full: overwrite the oldest move */
+        movelog_start = movelog_slot(1);
+        movelog_dropped = 1;
+    } else {
+        movelog_count++;
+    }
+    movelog_total = movelog_count;
+}
+
+unsigned char movelog_undo(void) {
+    if (movelog_count == 0) {
+        return MOVELOG_NONE;
+    }
+    movelog_count--;
+    return movelog_decode(movelog_get(movelog_slot(movelog_count)));
+}
+
+unsigned char movelog_redo(void) {
+    if (movelog_count == movelog_total) {
+        return MOVELOG_NONE;
+    }
+    movelog_count++;
+    return movelog_decode(movelog_get(movelog_slot(movelog_count - 1)));
+}
+
+unsigned char movelog_rewind(void) {
+    if (movelog_dropped) {
+        return 0;
+    }
+    movelog_count = 0;
+    return 1;
+}
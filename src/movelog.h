@@ -0,0 +1,37 @@
+#ifndef MOVELOG_H
+#define MOVELOG_H
+
+/*
+ * Move history for the current level, bit-packed into a RAM ring. Each
+ * move is a (from, to) code: 3 bits with 3 pegs (6 possible moves), 4 bits
+ * with 4 pegs (12). 96 bytes hold 255 moves with 3 pegs and 192 with 4;
+ * past that the oldest moves drop off. Moves are appended, undone and
+ * redone in constant time; a new move after an undo discards the redo tail.
+ */
+
+#define MOVELOG_BYTES 96
+#define MOVELOG_NONE 0xFF                /* No move to undo/redo */
+
+extern unsigned char movelog_data[MOVELOG_BYTES + 1];  /* Extra byte: codes may straddle the end */
+extern unsigned char movelog_width;      /* Bits per code: 3 or 4 */
+extern unsigned char movelog_start;      /* Ring slot of the oldest move */
+extern unsigned char movelog_count;      /* Moves applied (undo depth) */
+extern unsigned char movelog_total;      /* Moves logged, including the redo tail */
+extern unsigned char movelog_dropped;    /* Oldest moves missing: overwritten, or made before a resume */
+
+/* Empty the log for a level with num_towers pegs */
+void movelog_reset(unsigned char num_towers);
+
+/* Append a completed move (clears the redo tail) */
+void movelog_push(unsigned char from, unsigned char to);
+
+/* Step back one move; returns the packed move to reverse, or MOVELOG_NONE */
+unsigned char movelog_undo(void);
+
+/* Step forward one move; returns the packed move to apply, or MOVELOG_NONE */
+unsigned char movelog_redo(void);
+
+/* Back to the start of the level for a replay; 0 if early moves were dropped */
+unsigned char movelog_rewind(void);
+
+#endif /* MOVELOG_H */
@@ -1,58 +1,85 @@
 #include "nes.h"
 #include "music.h"
+#include "region.h"
 
 /* Jingle Bells melody (simplified) */
-const music_note_t jingle_bells[] = {
-    {NOTE_E4, 15}, {NOTE_E4, 15}, {NOTE_E4, 30},
-    {NOTE_E4, 15}, {NOTE_E4, 15}, {NOTE_E4, 30},
-    {NOTE_E4, 15}, {NOTE_G4, 15}, {NOTE_C4, 15}, {NOTE_D4, 15},
-    {NOTE_E4, 60},
-    {NOTE_F4, 15}, {NOTE_F4, 15}, {NOTE_F4, 15}, {NOTE_F4, 15},
-    {NOTE_F4, 15}, {NOTE_E4, 15}, {NOTE_E4, 15}, {NOTE_E4, 8}, {NOTE_E4, 7},
-    {NOTE_E4, 15}, {NOTE_D4, 15}, {NOTE_D4, 15}, {NOTE_E4, 15},
-    {NOTE_D4, 30}, {NOTE_G4, 30},
-    {NOTE_E4, 15}, {NOTE_E4, 15}, {NOTE_E4, 30},
-    {NOTE_E4, 15}, {NOTE_E4, 15}, {NOTE_E4, 30},
-    {NOTE_E4, 15}, {NOTE_G4, 15}, {NOTE_C4, 15}, {NOTE_D4, 15},
-    {NOTE_E4, 60},
-    {NOTE_F4, 15}, {NOTE_F4, 15}, {NOTE_F4, 15}, {NOTE_F4, 15},
-    {NOTE_F4, 15}, {NOTE_E4, 15}, {NOTE_E4, 15}, {NOTE_E4, 8}, {NOTE_E4, 7},
-    {NOTE_G4, 15}, {NOTE_G4, 15}, {NOTE_F4, 15}, {NOTE_D4, 15},
-    {NOTE_C4, 60},
-    {NOTE_REST, 0}  /* End marker */
+static const unsigned char jingle_bells_lengths[] = {0, 15, 30, 60, 8, 7};
+#define Q(n) MUSIC_NOTE(NOTE_##n, 1)  /* Quarter */
+#define H(n) MUSIC_NOTE(NOTE_##n, 2)  /* Half */
+#define W(n) MUSIC_NOTE(NOTE_##n, 3)  /* Whole */
+#define S(n) MUSIC_NOTE(NOTE_##n, 4)  /* Quarter split in two: 8 ticks */
+#define T(n) MUSIC_NOTE(NOTE_##n, 5)  /* ...then 7 */
+static const unsigned char jingle_bells_notes[] = {
+    Q(E4), Q(E4), H(E4),
+    Q(E4), Q(E4), H(E4),
+    Q(E4), Q(G4), Q(C4), Q(D4),
+    W(E4),
+    Q(F4), Q(F4), Q(F4), Q(F4),
+    Q(F4), Q(E4), Q(E4), S(E4), T(E4),
+    Q(E4), Q(D4), Q(D4), Q(E4),
+    H(D4), H(G4),
+    Q(E4), Q(E4), H(E4),
+    Q(E4), Q(E4), H(E4),
+    Q(E4), Q(G4), Q(C4), Q(D4),
+    W(E4),
+    Q(F4), Q(F4), Q(F4), Q(F4),
+    Q(F4), Q(E4), Q(E4), S(E4), T(E4),
+    Q(G4), Q(G4), Q(F4), Q(D4),
+    W(C4),
+    MUSIC_END
 };
+#undef Q
+#undef H
+#undef W
+#undef S
+#undef T
 
 /* Ode to Joy melody (Beethoven's 9th Symphony) */
-const music_note_t ode_to_joy[] = {
-    {NOTE_E4, 20}, {NOTE_E4, 20}, {NOTE_F4, 20}, {NOTE_G4, 20},
-    {NOTE_G4, 20}, {NOTE_F4, 20}, {NOTE_E4, 20}, {NOTE_D4, 20},
-    {NOTE_C4, 20}, {NOTE_C4, 20}, {NOTE_D4, 20}, {NOTE_E4, 20},
-    {NOTE_E4, 30}, {NOTE_D4, 10}, {NOTE_D4, 40},
-
-    {NOTE_E4, 20}, {NOTE_E4, 20}, {NOTE_F4, 20}, {NOTE_G4, 20},
-    {NOTE_G4, 20}, {NOTE_F4, 20}, {NOTE_E4, 20}, {NOTE_D4, 20},
-    {NOTE_C4, 20}, {NOTE_C4, 20}, {NOTE_D4, 20}, {NOTE_E4, 20},
-    {NOTE_D4, 30}, {NOTE_C4, 10}, {NOTE_C4, 40},
-
-    {NOTE_D4, 20}, {NOTE_D4, 20}, {NOTE_E4, 20}, {NOTE_C4, 20},
-    {NOTE_D4, 20}, {NOTE_E4, 10}, {NOTE_F4, 10}, {NOTE_E4, 20}, {NOTE_C4, 20},
-    {NOTE_D4, 20}, {NOTE_E4, 10}, {NOTE_F4, 10}, {NOTE_E4, 20}, {NOTE_D4, 20},
-    {NOTE_C4, 20}, {NOTE_D4, 20}, {NOTE_G3, 40},
-
-    {NOTE_E4, 20}, {NOTE_E4, 20}, {NOTE_F4, 20}, {NOTE_G4, 20},
-    {NOTE_G4, 20}, {NOTE_F4, 20}, {NOTE_E4, 20}, {NOTE_D4, 20},
-    {NOTE_C4, 20}, {NOTE_C4, 20}, {NOTE_D4, 20}, {NOTE_E4, 20},
-    {NOTE_D4, 30}, {NOTE_C4, 10}, {NOTE_C4, 40},
-
-    {NOTE_REST, 0}  /* End marker */
+static const unsigned char ode_to_joy_lengths[] = {0, 20, 30, 10, 40};
+#define Q(n) MUSIC_NOTE(NOTE_##n, 1)  /* Quarter */
+#define D(n) MUSIC_NOTE(NOTE_##n, 2)  /* Dotted quarter */
+#define E(n) MUSIC_NOTE(NOTE_##n, 3)  /* Eighth */
+#define H(n) MUSIC_NOTE(NOTE_##n, 4)  /* Half */
+static const unsigned char ode_to_joy_notes[] = {
+    Q(E4), Q(E4), Q(F4), Q(G4),
+    Q(G4), Q(F4), Q(E4), Q(D4),
+    Q(C4), Q(C4), Q(D4), Q(E4),
+    D(E4), E(D4), H(D4),
+
+    Q(E4), Q(E4), Q(F4), Q(G4),
+    Q(G4), Q(F4), Q(E4), Q(D4),
+    Q(C4), Q(C4), Q(D4), Q(E4),
+    D(D4), E(C4), H(C4),
+
+    Q(D4), Q(D4), Q(E4), Q(C4),
+    Q(D4), E(E4), E(F4), Q(E4), Q(C4),
+    Q(D4), E(E4), E(F4), Q(E4), Q(D4),
+    Q(C4), Q(D4), H(G3),
+
+    Q(E4), Q(E4), Q(F4), Q(G4),
+    Q(G4), Q(F4), Q(E4), Q(D4),
+    Q(C4), Q(C4), Q(D4), Q(E4),
+    D(D4), E(C4), H(C4),
+
+    MUSIC_END
 };
+#undef Q
+#undef D
+#undef E
+#undef H
+
+static const music_track_t jingle_bells = {jingle_bells_notes, jingle_bells_lengths};
+static const music_track_t ode_to_joy = {ode_to_joy_notes, ode_to_joy_lengths};
 
 /* Music state */
-static const music_note_t* current_song = 0;
+static const music_track_t* current_song = 0;
 static unsigned char note_index = 0;
 static unsigned char note_timer = 0;
 static unsigned char music_playing = 0;
 
+const unsigned char* note_period_lo;
+const unsigned char* note_period_hi;
+
 /* Initialize the APU for music */
 void init_music(void) {
     /* Enable square wave channels */
@@ -65,6 +92,9 @@ void init_music(void) {
     /* Configure triangle channel for bass */
     APU_TRIANGLE_CTRL = 0x81;
 
+    note_period_lo = period_lo[region];
+    note_period_hi = period_hi[region];
+
     music_playing = 0;
 }
 
@@ -72,10 +102,10 @@ void init_music(void) {
 void play_song(unsigned char song_id) {
     switch (song_id) {
         case SONG_JINGLE_BELLS:
-            current_song = jingle_bells;
+            current_song = &jingle_bells;
             break;
         case SONG_ODE_TO_JOY:
-            current_song = ode_to_joy;
+            current_song = &ode_to_joy;
             break;
         default:
             current_song = 0;
@@ -93,13 +123,10 @@ void stop_music(void) {
     APU_PULSE1_CTRL = 0x30;  /* Silence */
 }
 
-/* Update music (call once per frame) */
-void update_music(void) {
-    unsigned int note;
-
-    if (!music_playing || current_song == 0) {
-        return;
-    }
+/* Advance music by one tick */
+static void music_tick(void) {
+    unsigned char code;
+    unsigned char note;
 
     /* Check if current note is finished */
     if (note_timer > 0) {
@@ -108,25 +135,39 @@ void update_music(void) {
     }
 
     /* Get next note */
-    note = current_song[note_index].note;
+    code = current_song->notes[note_index];
 
     /* Check for end of song */
-    if (note == NOTE_REST && current_song[note_index].duration == 0) {
+    if (code == MUSIC_END) {
         /* Loop the song */
         note_index = 0;
-        note = current_song[note_index].note;
+        code = current_song->notes[0];
     }
+    note = MUSIC_NOTE_INDEX(code);
 
     /* Play the note */
     if (note == NOTE_REST) {
         APU_PULSE1_CTRL = 0x30;  /* Silence */
     } else {
         APU_PULSE1_CTRL = 0xBF;
-        APU_PULSE1_TIMER_LO = (unsigned char)(note & 0xFF);
-        APU_PULSE1_TIMER_HI = (unsigned char)((note >> 8) & 0x07);  /* Only write timer bits, not length */
+        APU_PULSE1_TIMER_LO = note_period_lo[note];
+        APU_PULSE1_TIMER_HI = note_period_hi[note];  /* Only write timer bits, not length */
     }
 
     /* Set note duration */
-    note_timer = current_song[note_index].duration;
+    note_timer = current_song->lengths[MUSIC_LENGTH_INDEX(code)];
     note_index++;
 }
+
+/* Update music (call once per frame) */
+void update_music(void) {
+    unsigned char ticks;
+
+    if (!music_playing || current_song == 0) {
+        return;
+    }
+
+    for (ticks = region_ticks; ticks != 0; ticks--) {
+        music_tick();
+    }
+}
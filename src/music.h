@@ -1,42 +1,23 @@
 #ifndef MUSIC_H
 #define MUSIC_H
 
-/* Note definitions (period values for APU) */
-#define NOTE_C3  0x07F1
-#define NOTE_D3  0x0713
-#define NOTE_E3  0x0640
-#define NOTE_F3  0x05F3
-#define NOTE_G3  0x0580
-#define NOTE_A3  0x04FA
-#define NOTE_B3  0x047C
-#define NOTE_C4  0x03F8
-#define NOTE_D4  0x0389
-#define NOTE_E4  0x031F
-#define NOTE_F4  0x02F9
-#define NOTE_G4  0x02BF
-#define NOTE_A4  0x027C
-#define NOTE_B4  0x023D
-#define NOTE_C5  0x01FB
-#define NOTE_D5  0x01C4
-#define NOTE_E5  0x018F
-#define NOTE_F5  0x017C
-#define NOTE_G5  0x015F
-#define NOTE_A5  0x013D
-#define NOTE_B5  0x011E
-#define NOTE_C6  0x00FD
-#define NOTE_D6  0x00E2
-#define NOTE_E6  0x00C7
-#define NOTE_F6  0x00BE
-#define NOTE_G6  0x00AF
-#define NOTE_A6  0x009E
-#define NOTE_B6  0x008F
-#define NOTE_REST 0x0000
+/* Note names (NOTE_C3-NOTE_B6, NOTE_REST) and the per-region period
+ * tables are generated by tools/gen_timebase.py */
+#include "timebase.h"
+
+/* Tracks store one byte per note: the NOTE_* index in the low 5 bits and,
+ * in the top 3, an index (1-7) into the track's length table. A zero byte
+ * (a rest of length index 0) ends the track. */
+#define MUSIC_NOTE(note, length) ((unsigned char)((note) | ((length) << 5)))
+#define MUSIC_NOTE_INDEX(code) ((code) & 0x1F)
+#define MUSIC_LENGTH_INDEX(code) ((code) >> 5)
+#define MUSIC_END 0x00
 
 /* Music track structure */
 typedef struct {
-    unsigned int note;     /* Note frequency */
-    unsigned char duration; /* Note duration in frames */
-} music_note_t;
+    const unsigned char* notes;    /* MUSIC_NOTE()s ending with MUSIC_END */
+    const unsigned char* lengths;  /* Note lengths in ticks (NTSC frames) */
+} music_track_t;
 
 /* Song selections */
 enum {
@@ -45,10 +26,14 @@ enum {
     SONG_ODE_TO_JOY
 };
 
-/* Music control functions */
+/* Period tables for the detected region, set by init_music() */
+extern const unsigned char* note_period_lo;
+extern const unsigned char* note_period_hi;
+
+/* Music control functions; call init_music() after region_detect() */
 void init_music(void);
 void play_song(unsigned char song_id);
 void stop_music(void);
-void update_music(void);
+void update_music(void);  /* Once per frame; plays region_ticks ticks */
 
 #endif /* MUSIC_H */
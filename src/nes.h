@@ -14,6 +14,11 @@
 #define OAM_DATA   (*(volatile unsigned char*)0x2004)
 #define OAM_DMA    (*(volatile unsigned char*)0x4014)
 
+/* Point the PPU at a VRAM address (high byte first); expands in place, so
+ * the two stores cost no call. addr is evaluated twice. */
+#define PPU_SET_ADDR(addr) (PPU_ADDR = (unsigned char)((addr) >> 8), \
+                            PPU_ADDR = (unsigned char)((addr) & 0xFF))
+
 /* APU (Audio Processing Unit) and Controller Registers */
 #define APU_PULSE1_CTRL (*(volatile unsigned char*)0x4000)
 #define APU_PULSE1_SWEEP (*(volatile unsigned char*)0x4001)
@@ -0,0 +1,101 @@
+; Multi-pad reader for race mode (read_pads in input.h)
+; One strobe, then 24 reads from each port: pad 1 / pad 2, pad 3 / pad 4,
+; then the Four Score signature. A plain pad answers 1 after its 8 buttons,
+; so the signature only matches with a Four Score attached; pads 3 and 4
+; read as nothing otherwise.
+
+.export _read_pads
+.import _pads, _pads_pressed, _pad_count
+.import _controller1, _controller1_prev, _controller1_pressed
+.importzp tmp1
+
+CONTROLLER1 = $4016
+CONTROLLER2 = $4017
+
+; Signatures as read, first bit in bit 0 like the buttons
+; ($4016: 0,0,0,1,0,0,0,0 / $4017: 0,0,1,0,0,0,0,0)
+SIGNATURE1 = $08
+SIGNATURE2 = $04
+
+.segment "BSS"
+
+port1:  .res 3          ; Pad 1, pad 3, signature
+port2:  .res 3          ; Pad 2, pad 4, signature
+
+.segment "CODE"
+
+; void read_pads(void);
+_read_pads:
+    lda #$01
+    sta CONTROLLER1
+    lda #$00
+    sta CONTROLLER1
+
+    ldx #$00
+@byte:
+    lda #$80            ; Sentinel: reaches the carry after 8 bits
+    sta port1,x
+    sta port2,x
+@bit:
+    lda CONTROLLER1
+    lsr a
+    ror port1,x
+    lda CONTROLLER2
+    lsr a
+    ror port2,x
+    bcc @bit
+    inx
+    cpx #3
+    bne @byte
+
+    ldy #$04
+    lda port1+2
+    cmp #SIGNATURE1
+    bne @two_pads
+    lda port2+2
+    cmp #SIGNATURE2
+    beq @four_pads
+@two_pads:
+    lda #$00
+    sta port1+1
+    sta port2+1
+    ldy #$02
+@four_pads:
+    sty _pad_count
+
+    ; Pad 1 edges go to controller1* too, as in read_controller(). Both
+    ; readers keep controller1 current, so it, not pads[0], is pad 1's last
+    ; state: after frames read by read_controller() (the title), a button
+    ; held since then is not a new press.
+    lda _controller1
+    sta _controller1_prev
+    sta _pads
+
+    ldx #$00
+    lda port1
+    jsr store_pad
+    lda port2
+    jsr store_pad
+    lda port1+1
+    jsr store_pad
+    lda port2+1
+    jsr store_pad
+
+    lda _pads
+    sta _controller1
+    lda _pads_pressed
+    sta _controller1_pressed
+    rts
+
+; pads[X] = A, pads_pressed[X] = buttons that went down; X advances
+store_pad:
+    tay
+    eor _pads,x
+    sta tmp1            ; Changed buttons
+    tya
+    and tmp1
+    sta _pads_pressed,x
+    tya
+    sta _pads,x
+    inx
+    rts
@@ -0,0 +1,118 @@
+#include "nes.h"
+#include "palette.h"
+
+#define PALETTE_END 0xFF
+
+unsigned char palette_shadow[PALETTE_SIZE];
+unsigned char palette_dirty;
+
+static unsigned char palette_base[PALETTE_SIZE];
+static unsigned char palette_level;
+static const unsigned char* effect_step;  /* Next level of the running effect, 0 = none */
+static unsigned char effect_wait;
+static void (*effect_done)(void);
+
+/* Brightness levels of each effect, PALETTE_END-terminated */
+static const unsigned char fade_in_levels[] = {0, 1, 2, 3, 4, PALETTE_END};
+static const unsigned char fade_out_levels[] = {3, 2, 1, 0, PALETTE_END};
+static const unsigned char flash_levels[] = {8, 7, 6, 5, 4, PALETTE_END};
+
+static const unsigned char* const effect_levels[] = {
+    fade_in_levels,
+    fade_out_levels,
+    flash_levels
+};
+
+/* Rebuild the shadow from the base colors at palette_level. A level moves a
+ * color one row ($10) per step in the NES palette: down to black, or up to
+ * white. The black column ($xD-$xF) only brightens, from dark gray. */
+static void palette_apply(void) {
+    unsigned char i;
+    unsigned char c;
+    unsigned char shift;
+
+    if (palette_level < PALETTE_LEVEL_NORMAL) {
+        shift = (unsigned char)((PALETTE_LEVEL_NORMAL - palette_level) << 4);
+        for (i = 0; i < PALETTE_SIZE; i++) {
+            c = palette_base[i];
+            if ((c & 0x0F) >= 0x0D || c < shift) {
+                c = COLOR_BLACK;
+            } else {
+                c -= shift;
+            }
+            palette_shadow[i] = c;
+        }
+    } else {
+        shift = (unsigned char)((palette_level - PALETTE_LEVEL_NORMAL) << 4);
+        for (i = 0; i < PALETTE_SIZE; i++) {
+            c = palette_base[i];
+            if (shift != 0) {
+                if ((c & 0x0F) >= 0x0D) {
+                    c = COLOR_DARK_GRAY;
+                }
+                c += shift;
+                if (c > 0x3F) {
+                    c = COLOR_WHITE;
+                }
+            }
+            palette_shadow[i] = c;
+        }
+    }
+    palette_dirty = 1;
+}
+
+void palette_load(const unsigned char* colors) {
+    unsigned char i;
+
+    for (i = 0; i < PALETTE_SIZE; i++) {
+        palette_base[i] = colors[i];
+    }
+    effect_step = 0;
+    effect_done = 0;
+    palette_level = PALETTE_LEVEL_NORMAL;
+    palette_apply();
+}
+
+void palette_set_bg(unsigned char color) {
+    palette_base[0] = color;
+    palette_base[16] = color;  /* $3F10 mirrors $3F00: keep the burst from undoing it */
+    palette_apply();
+}
+
+void palette_effect(unsigned char effect, void (*done)(void)) {
+    effect_step = effect_levels[effect];
+    effect_done = done;
+    effect_wait = PALETTE_STEP_FRAMES;
+    palette_level = *effect_step++;
+    palette_apply();
+}
+
+void palette_cancel(void) {
+    effect_step = 0;
+    effect_done = 0;
+    if (palette_level != PALETTE_LEVEL_NORMAL) {
+        palette_level = PALETTE_LEVEL_NORMAL;
+        palette_apply();
+    }
+}
+
+void palette_step(void) {
+    void (*done)(void);
+
+    if (effect_step == 0 || --effect_wait != 0) {
+        return;
+    }
+    if (*effect_step == PALETTE_END) {
+        /* Last level held for a step: finished */
+        done = effect_done;
+        effect_step = 0;
+        effect_done = 0;
+        if (done != 0) {
+            done();
+        }
+        return;
+    }
+    palette_level = *effect_step++;
+    effect_wait = PALETTE_STEP_FRAMES;
+    palette_apply();
+}
@@ -0,0 +1,53 @@
+#ifndef PALETTE_H
+#define PALETTE_H
+
+/*
+ * Palette shadow and fades. The 32 palette bytes live in RAM and reach the
+ * PPU in one unrolled burst (palette_upload), during vblank or with
+ * rendering off, and only after a change. Colors are kept at full
+ * brightness in a base copy; the shadow is rebuilt from it at the current
+ * brightness level: 0 is black, 4 normal, 8 white. Effects step the level
+ * through a short table, one entry every PALETTE_STEP_FRAMES frames.
+ */
+
+#define PALETTE_SIZE 32
+#define PALETTE_LEVEL_BLACK 0
+#define PALETTE_LEVEL_NORMAL 4
+#define PALETTE_LEVEL_WHITE 8
+#define PALETTE_STEP_FRAMES 3
+
+/* Effects for palette_effect() */
+enum {
+    PALETTE_FADE_IN,   /* Black up to normal */
+    PALETTE_FADE_OUT,  /* Normal down to black */
+    PALETTE_FLASH      /* White back down to normal */
+};
+
+/* Frames an effect takes from its first step to the last */
+#define PALETTE_FADE_FRAMES (4 * PALETTE_STEP_FRAMES)
+
+extern unsigned char palette_shadow[PALETTE_SIZE];  /* What palette_upload() writes */
+extern unsigned char palette_dirty;                 /* Shadow changed since the last upload */
+
+/* Set all 32 base colors (normal level, no effect running) */
+void palette_load(const unsigned char* colors);
+
+/* Set the backdrop color ($3F00 and its $3F10 mirror) */
+void palette_set_bg(unsigned char color);
+
+/* Start an effect; its first level applies at once. done (or 0) runs from
+ * palette_step() once the last level is reached. Replaces a running
+ * effect without calling its done. */
+void palette_effect(unsigned char effect, void (*done)(void));
+
+/* Drop a running effect and its done; back to the normal level */
+void palette_cancel(void);
+
+/* Advance a running effect; call once per frame */
+void palette_step(void);
+
+/* Upload the shadow if dirty; vblank or rendering off. Leaves the PPU
+ * address in the palette, so the caller resets the scroll after. */
+void palette_upload(void);
+
+#endif /* PALETTE_H */
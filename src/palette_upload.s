@@ -0,0 +1,31 @@
+; Palette shadow upload (called from the vblank part of the main loop and
+; from screens built with rendering off; see palette.h)
+; The 32 shadow bytes go to $3F00-$3F1F unrolled, 8 cycles each: about 290
+; cycles with the setup, and only when palette_dirty is set.
+
+.export _palette_upload
+.import _palette_shadow, _palette_dirty
+
+PPU_STATUS = $2002
+PPU_ADDR = $2006
+PPU_DATA = $2007
+
+.segment "CODE"
+
+; void palette_upload(void);
+_palette_upload:
+    lda _palette_dirty
+    beq @done
+    bit PPU_STATUS      ; Reset the address latch
+    lda #$3F
+    sta PPU_ADDR
+    lda #$00
+    sta PPU_ADDR
+.repeat 32, I
+    lda _palette_shadow+I
+    sta PPU_DATA
+.endrepeat
+    lda #$00
+    sta _palette_dirty
+@done:
+    rts
@@ -0,0 +1,323 @@
+#include "nes.h"
+#include "hanoi.h"
+#include "input.h"
+#include "sprite.h"
+#include "vram.h"
+#include "sfx.h"
+#include "palette.h"
+#include "text.h"
+#include "strings.h"
+#include "race.h"
+
+/* Board layout in tiles: player p's board starts at column (p & 1) * 16
+ * and row RACE_TOP + (p >> 1) * RACE_BOARD_STEP */
+#define RACE_TOP 3
+#define RACE_BOARD_STEP 13
+#define RACE_POLE0 3           /* Pole columns 3, 7 and 11 of each board */
+#define RACE_POLE_STEP 4
+#define RACE_HUD_ROW 0         /* Rows within a board */
+#define RACE_CURSOR_ROW 1
+#define RACE_HOVER_ROW 2
+#define RACE_BASE_ROW (RACE_HOVER_ROW + RACE_LEVELS + 1)
+#define RACE_WINDOW 3          /* Tiles a disk row takes per tower */
+#define RACE_HOVER_LEN (2 * RACE_POLE_STEP + RACE_WINDOW)
+#define RACE_HUD_LEN 5         /* Level digit, blank, 3 move digits */
+#define RACE_CURSOR_TILE 0x21
+#define RACE_NO_WINNER 0xFF
+
+/* Pending tile updates per player */
+#define RACE_DIRTY_HOVER 0x01
+#define RACE_DIRTY_HUD 0x02
+
+/* Disk tiles by size: left edge, center, right edge (chr_rom.s $60-$65).
+ * Sizes are 8-24 pixels wide in 4-pixel steps, colors 1-3 in turn. */
+static const unsigned char race_disk_tiles[RACE_LEVELS][RACE_WINDOW] = {
+    {0x00, 0x08, 0x00},
+    {0x60, 0x09, 0x61},
+    {0x62, 0x01, 0x63},
+    {0x64, 0x08, 0x65},
+    {0x09, 0x09, 0x09}
+};
+
+/* Attribute bytes by attribute row: background palette 1 under the disk
+ * rows of both board rows (tile rows 4-11 and 18-25), palette 0 for text */
+static const unsigned char race_attr_rows[8] = {
+    0x00, 0x55, 0x55, 0x00, 0x50, 0x55, 0x05, 0x00
+};
+
+static game_state_t race_game[INPUT_PADS];
+static unsigned char race_players;
+static unsigned char race_winner;
+static unsigned char race_dirty[INPUT_PADS];
+static unsigned char race_dirty_rows[INPUT_PADS][MIN_TOWERS];  /* Bit h = disk row h */
+static unsigned char race_first;  /* Player whose updates queue first */
+
+static unsigned int race_board_addr(unsigned char player, unsigned char row, unsigned char col) {
+    return 0x2000 + (unsigned int)(RACE_TOP + (player >> 1) * RACE_BOARD_STEP + row) * 32 +
+           ((player & 1) << 4) + col;
+}
+
+/* First tile column of a tower's window */
+#define race_window_col(tower) (RACE_POLE0 - 1 + (tower) * RACE_POLE_STEP)
+
+/* Window tiles for disk `size` (0 = none; the center shows `empty`) */
+static void race_window_tiles(unsigned char* dst, unsigned char size, unsigned char empty) {
+    if (size == 0) {
+        dst[0] = 0x00;
+        dst[1] = empty;
+        dst[2] = 0x00;
+        return;
+    }
+    dst[0] = race_disk_tiles[size - 1][0];
+    dst[1] = race_disk_tiles[size - 1][1];
+    dst[2] = race_disk_tiles[size - 1][2];
+}
+
+/* Tiles of disk row `height` of a tower (pole tile where empty) */
+static void race_row_tiles(unsigned char* dst, game_state_t* game, unsigned char tower,
+                           unsigned char height) {
+    race_window_tiles(dst, game->towers[tower][height], 0x06);
+}
+
+/* Hover row: the held disk over the selected tower, blank elsewhere */
+static void race_hover_tiles(unsigned char* dst, game_state_t* game) {
+    unsigned char i;
+
+    for (i = 0; i < RACE_HOVER_LEN; i++) {
+        dst[i] = 0x00;
+    }
+    if (game->holding_block != 0) {
+        race_window_tiles(dst + game->selected_tower * RACE_POLE_STEP, game->holding_block, 0x00);
+    }
+}
+
+static void race_hud_tiles(unsigned char* dst, game_state_t* game) {
+    unsigned char moves = game->moves;
+
+    dst[0] = 0x10 + game->level;
+    dst[1] = 0x00;
+    dst[4] = 0x10 + moves % 10;
+    moves /= 10;
+    dst[3] = 0x10 + moves % 10;
+    dst[2] = 0x10 + moves / 10;
+}
+
+/* Redraw everything on a player's board at the next vblanks */
+static void race_mark_board(unsigned char player) {
+    unsigned char tower;
+
+    race_dirty[player] = RACE_DIRTY_HOVER | RACE_DIRTY_HUD;
+    for (tower = 0; tower < MIN_TOWERS; tower++) {
+        race_dirty_rows[player][tower] = (1 << RACE_LEVELS) - 1;
+    }
+}
+
+/* Queue a player's pending updates; 0 once the VRAM queue is full */
+static unsigned char race_queue_player(unsigned char player) {
+    game_state_t* game = &race_game[player];
+    unsigned char* dst;
+    unsigned char tower;
+    unsigned char height;
+    unsigned char rows;
+
+    if (race_dirty[player] & RACE_DIRTY_HOVER) {
+        dst = vram_begin(race_board_addr(player, RACE_HOVER_ROW, race_window_col(0)), RACE_HOVER_LEN);
+        if (dst == 0) {
+            return 0;
+        }
+        race_hover_tiles(dst, game);
+        race_dirty[player] &= ~RACE_DIRTY_HOVER;
+    }
+
+    for (tower = 0; tower < MIN_TOWERS; tower++) {
+        rows = race_dirty_rows[player][tower];
+        for (height = 0; rows != 0; height++, rows >>= 1) {
+            if (!(rows & 1)) {
+                continue;
+            }
+            dst = vram_begin(race_board_addr(player, RACE_BASE_ROW - 1 - height, race_window_col(tower)),
+                             RACE_WINDOW);
+            if (dst == 0) {
+                return 0;
+            }
+            race_row_tiles(dst, game, tower, height);
+            race_dirty_rows[player][tower] &= ~(1 << height);
+        }
+    }
+
+    if (race_dirty[player] & RACE_DIRTY_HUD) {
+        dst = vram_begin(race_board_addr(player, RACE_HUD_ROW, 5), RACE_HUD_LEN);
+        if (dst == 0) {
+            return 0;
+        }
+        race_hud_tiles(dst, game);
+        race_dirty[player] &= ~RACE_DIRTY_HUD;
+    }
+    return 1;
+}
+
+/* Apply one player's presses; A picks up or places, B puts the disk back */
+static void race_input(unsigned char player) {
+    game_state_t* game = &race_game[player];
+    unsigned char pressed = pads_pressed[player];
+    unsigned char tower;
+
+    if ((pressed & BUTTON_LEFT) && game->selected_tower > 0) {
+        game->selected_tower--;
+        race_dirty[player] |= RACE_DIRTY_HOVER;
+    }
+    if ((pressed & BUTTON_RIGHT) && game->selected_tower < MIN_TOWERS - 1) {
+        game->selected_tower++;
+        race_dirty[player] |= RACE_DIRTY_HOVER;
+    }
+
+    tower = game->selected_tower;
+    if (pressed & BUTTON_A) {
+        if (game->holding_block == 0) {
+            if (pickup_block(game, tower)) {
+                race_dirty_rows[player][tower] |= 1 << game->tower_heights[tower];
+                race_dirty[player] |= RACE_DIRTY_HOVER;
+            }
+        } else if (place_block(game, tower)) {
+            race_dirty_rows[player][tower] |= 1 << (game->tower_heights[tower] - 1);
+            race_dirty[player] |= RACE_DIRTY_HOVER | RACE_DIRTY_HUD;
+
+            /* Any clear counts in a race, optimal or not */
+            if (check_win(game) != 0) {
+                play_sfx_success();
+                if (game->level == RACE_LEVELS) {
+                    race_winner = player;
+                    return;
+                }
+                game->level++;
+                start_level(game);
+                race_mark_board(player);
+            }
+        }
+    } else if ((pressed & BUTTON_B) && game->holding_block != 0) {
+        tower = game->holding_from;
+        place_block(game, tower);
+        race_dirty_rows[player][tower] |= 1 << (game->tower_heights[tower] - 1);
+        race_dirty[player] |= RACE_DIRTY_HOVER;
+    }
+}
+
+void race_start(void) {
+    unsigned char player;
+    unsigned char tower;
+    unsigned char row;
+    unsigned char i;
+    unsigned char tiles[RACE_HOVER_LEN];
+
+    /* Detect the Four Score; this read also primes the edge detection */
+    read_pads();
+    race_players = pad_count;
+    race_winner = RACE_NO_WINNER;
+    race_first = 0;
+
+    /* Rendering and NMI off: the redraw runs from mid-frame and can cross
+     * a vblank, where crt0's NMI would reset the PPU address */
+    PPU_MASK = 0;
+    PPU_CTRL = 0;
+    PPU_STATUS;
+    PPU_ADDR = 0x20;
+    PPU_ADDR = 0x00;
+    for (i = 0; i < 240; i++) {
+        PPU_DATA = 0x00;
+        PPU_DATA = 0x00;
+        PPU_DATA = 0x00;
+        PPU_DATA = 0x00;
+    }
+    for (i = 0; i < 64; i++) {
+        PPU_DATA = race_attr_rows[i >> 3];
+    }
+
+    text_draw(14, 1, str_race_title);
+
+    clear_sprites();
+    for (player = 0; player < race_players; player++) {
+        init_game(&race_game[player], MIN_TOWERS);
+        race_dirty[player] = 0;
+
+        /* HUD: "Pn L" then the level digit and the moves */
+        for (i = 0; i < STR_RACE_HUD_LEN; i++) {
+            tiles[i] = str_race_hud[i + 1];
+        }
+        tiles[1] = 0x11 + player;
+        race_hud_tiles(tiles + STR_RACE_HUD_LEN, &race_game[player]);
+        text_draw_tiles(((player & 1) << 4) + 1, RACE_TOP + (player >> 1) * RACE_BOARD_STEP + RACE_HUD_ROW,
+                        tiles, STR_RACE_HUD_LEN + RACE_HUD_LEN);
+
+        for (tower = 0; tower < MIN_TOWERS; tower++) {
+            for (row = 0; row < RACE_LEVELS; row++) {
+                PPU_STATUS;
+                PPU_SET_ADDR(race_board_addr(player, RACE_BASE_ROW - 1 - row, race_window_col(tower)));
+                race_row_tiles(tiles, &race_game[player], tower, row);
+                PPU_DATA = tiles[0];
+                PPU_DATA = tiles[1];
+                PPU_DATA = tiles[2];
+            }
+            race_dirty_rows[player][tower] = 0;
+
+            PPU_STATUS;
+            PPU_SET_ADDR(race_board_addr(player, RACE_BASE_ROW, race_window_col(tower)));
+            PPU_DATA = 0x07;  /* Base tile */
+            PPU_DATA = 0x07;
+            PPU_DATA = 0x07;
+        }
+    }
+
+    palette_upload();
+    PPU_STATUS;
+    PPU_SCROLL = 0;
+    PPU_SCROLL = 0;
+    PPU_CTRL = PPU_CTRL_NMI;
+    PPU_MASK = PPU_MASK_SHOW_BG | PPU_MASK_SHOW_SPRITES;
+}
+
+unsigned char race_update(void) {
+    unsigned char player;
+    unsigned char* dst;
+    sprite_t* cursor;
+
+    if (race_winner != RACE_NO_WINNER) {
+        /* Any player's Start leaves */
+        for (player = 0; player < race_players; player++) {
+            if (pads_pressed[player] & BUTTON_START) {
+                return 0;
+            }
+        }
+    } else {
+        for (player = 0; player < race_players && race_winner == RACE_NO_WINNER; player++) {
+            race_input(player);
+        }
+        if (race_winner != RACE_NO_WINNER) {
+            dst = vram_begin(TEXT_ADDR(12, RACE_TOP + RACE_BOARD_STEP - 2), STR_RACE_WINS_LEN);
+            if (dst != 0) {
+                for (player = 0; player < STR_RACE_WINS_LEN; player++) {
+                    dst[player] = str_race_wins[player + 1];
+                }
+                dst[1] = 0x11 + race_winner;
+            }
+        }
+    }
+
+    /* Cursors: one sprite per player above the selected pole, in its palette */
+    for (player = 0; player < race_players; player++) {
+        cursor = &oam_buffer[FIRST_GAME_SPRITE + player];
+        cursor->y = (unsigned char)((RACE_TOP + (player >> 1) * RACE_BOARD_STEP + RACE_CURSOR_ROW) * 8 - 1);
+        cursor->x = (unsigned char)((((player & 1) << 4) + RACE_POLE0 +
+                                     race_game[player].selected_tower * RACE_POLE_STEP) * 8);
+        cursor->tile = RACE_CURSOR_TILE;
+        cursor->attributes = player;
+    }
+
+    /* Pending tiles, players taking turns at the head of the queue */
+    for (player = 0; player < race_players; player++) {
+        if (!race_queue_player((unsigned char)((race_first + player) & (race_players - 1)))) {
+            break;
+        }
+    }
+    race_first = (race_first + 1) & (race_players - 1);
+    return 1;
+}
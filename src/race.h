@@ -0,0 +1,28 @@
+#ifndef RACE_H
+#define RACE_H
+
+/*
+ * Race mode: two players (four with a Four Score) each solve levels 1 to
+ * RACE_LEVELS on their own 3-peg board, all on one screen; the first to
+ * clear the last level wins. Boards are 16 tiles wide, side by side, with
+ * a second row of boards for players 3 and 4.
+ *
+ * Resting and held disks are background tiles, so only the cursors are
+ * sprites (one per player): nowhere near the 64-sprite or 8-per-line
+ * limits. A move redraws a 3-tile window on one disk row plus the board's
+ * hover row; with the HUD digits that is at most 28 bytes per player per
+ * frame, so two players always fit the VRAM queue. Changes that do not fit
+ * stay pending and go out in the next vblank, players taking turns first.
+ */
+
+#define RACE_LEVELS 5  /* Widest disk: 3 tiles */
+
+/* Draw the race screen with rendering off and start every board */
+void race_start(void);
+
+/* One frame of the race from this frame's read_pads(): moves, cursors and
+ * queued tile updates. Returns 0 once the race is over and a player has
+ * pressed Start to leave. */
+unsigned char race_update(void);
+
+#endif /* RACE_H */
@@ -0,0 +1,42 @@
+#include "region.h"
+#include "timebase.h"
+
+/* region_frame_length() counts; midpoints between the expected values */
+#define REGION_PAL_MIN 2626     /* NTSC ~2482, PAL ~2771 */
+#define REGION_DENDY_MIN 2863   /* Dendy ~2955 */
+#define REGION_MISSED_MIN 4000  /* Two frames: a vblank flag was missed */
+#define REGION_TRIES 4
+
+unsigned char region;
+unsigned char region_ticks;
+static unsigned char tempo_accum;
+
+void region_detect(void) {
+    unsigned int length;
+    unsigned char tries;
+
+    /* NTSC unless a clean measurement says otherwise */
+    region = REGION_NTSC;
+    for (tries = 0; tries < REGION_TRIES; tries++) {
+        length = region_frame_length();
+        if (length >= REGION_MISSED_MIN) {
+            continue;
+        }
+        if (length >= REGION_DENDY_MIN) {
+            region = REGION_DENDY;
+        } else if (length >= REGION_PAL_MIN) {
+            region = REGION_PAL;
+        }
+        break;
+    }
+
+    tempo_accum = 0;
+    region_ticks = 1;
+}
+
+void region_tick(void) {
+    unsigned char before = tempo_accum;
+
+    tempo_accum += tempo_step[region];
+    region_ticks = (tempo_accum < before) ? 2 : 1;
+}
@@ -0,0 +1,32 @@
+#ifndef REGION_H
+#define REGION_H
+
+/*
+ * Console region and timebase. Durations throughout the game (song notes,
+ * sound effects, scheduler timers, disk motion) are written in NTSC frames,
+ * called ticks here. On NTSC every frame is one tick; on PAL and Dendy a
+ * frame is ~1.2 ticks, so a tempo accumulator hands out a second tick on
+ * about every fifth frame and everything keeps its wall-clock length.
+ */
+
+/* Order matches the generated tables in timebase.h */
+enum {
+    REGION_NTSC,
+    REGION_PAL,
+    REGION_DENDY
+};
+
+extern unsigned char region;        /* REGION_* */
+extern unsigned char region_ticks;  /* Ticks in the current frame: 1 or 2 */
+
+/* Time one frame with rendering and NMI off and set region. Call once at
+ * boot; takes two to three frames. */
+void region_detect(void);
+
+/* Advance the tempo accumulator; call once per frame before any timers */
+void region_tick(void);
+
+/* CPU loop iterations (12 cycles each) from one vblank flag to the next */
+unsigned int __fastcall__ region_frame_length(void);
+
+#endif /* REGION_H */
@@ -0,0 +1,40 @@
+; Region detection frame timer (called from region_detect in region.c)
+; Polls the vblank flag in a loop of fixed length and counts the iterations
+; of one whole frame. A frame is 29780.5 CPU cycles on NTSC, 33247.5 on PAL
+; and 35464 on Dendy, so at 12 cycles per iteration the count lands near
+; 2482, 2771 or 2955. Polling can miss a flag that sets on the very cycle
+; it is read; the count then covers two frames and the caller retries.
+
+.export _region_frame_length
+
+PPU_STATUS = $2002
+
+.segment "CODE"
+
+; unsigned int __fastcall__ region_frame_length(void);
+; NMI must be off. Returns the iteration count in A (low) / X (high).
+_region_frame_length:
+    bit PPU_STATUS      ; Drop a flag left over from before the call
+@sync:
+    bit PPU_STATUS
+    bpl @sync
+
+    ldx #$00
+    ldy #$00
+@count:
+    inx                 ; 2
+    bne @poll           ; 3 (2 + iny's 2 once every 256 passes)
+    iny
+@poll:
+    bit PPU_STATUS      ; 4
+    bpl @count          ; 3
+    ; A taken branch into another page costs a cycle and would shift every
+    ; count by 8%, enough to read PAL as NTSC.
+    .assert >@count = >*, lderror, "region_frame_length loop crosses a page"
+
+    txa
+    pha
+    tya
+    tax
+    pla
+    rts
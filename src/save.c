@@ -0,0 +1,285 @@
+#include <stddef.h>
+#include "hanoi.h"
+#include "save.h"
+#include "movelog.h"
+
+#define SAVE_MAGIC 0x48               /* Bumped whenever the layout changes */
+#define SAVE_NONE 0xFF
+
+typedef struct {
+    unsigned char magic;              /* Written last: commit marker */
+    unsigned char seq;                /* Newer bank wins (wrapping compare) */
+    save_level_t level[SAVE_MODES][SAVE_LEVELS];
+    unsigned char best_streak[SAVE_MODES];
+    unsigned char sum1;               /* Fletcher-16 over magic..best_streak */
+    unsigned char sum2;
+} save_bank_t;
+
+#define SAVE_SUM_BYTES (sizeof(save_bank_t) - 2)
+
+#define SAVE_SNAP_MAGIC 0x53          /* Must match SNAP_MAGIC in snapshot.s */
+#define SAVE_SNAP_FIELDS 10           /* Must match SNAP_FIELDS in snapshot.s */
+
+/*
+ * Field order is fixed: snapshot.s writes the scalars in save_snap_fields
+ * order, then the pegs. The stacks are always sorted, so one peg per disk
+ * rebuilds them; num_blocks and min_moves follow from the level.
+ */
+typedef struct {
+    unsigned char magic;              /* Written last: commit marker */
+    unsigned char state;              /* Main loop state at the time */
+    unsigned char level;
+    unsigned char lives;
+    unsigned char num_towers;
+    unsigned char moves;
+    unsigned char selected_tower;
+    unsigned int level_frames;
+    unsigned char first_try;
+    unsigned char streak;
+    unsigned char practice;
+    unsigned char pegs[MAX_BLOCKS];   /* Peg of disks 1..num_blocks */
+    unsigned char sum;                /* 8-bit sum of state..pegs[num_blocks - 1] */
+} save_snapshot_t;
+
+#define SAVE_LOG_MAGIC 0x4C
+
+/* Last cleared level's moves; decode with movelog.h rules */
+typedef struct {
+    unsigned char magic;              /* Written last: commit marker */
+    unsigned char num_towers;
+    unsigned char level;
+    unsigned char width;              /* Bits per move code */
+    unsigned char start;              /* Ring slot of the first move */
+    unsigned char count;              /* Moves in the ring */
+    unsigned char data[MOVELOG_BYTES + 1];
+    unsigned char sum;                /* 8-bit sum of num_towers..data */
+} save_movelog_t;
+
+#pragma bss-name (push, "SAVE")
+static save_bank_t save_bank[2];
+save_snapshot_t save_snap;
+static save_movelog_t save_log;
+#pragma bss-name (pop)
+
+/* Where snapshot.s reads each field and the stacks in game_state_t */
+const unsigned char save_snap_fields[SAVE_SNAP_FIELDS] = {
+    offsetof(game_state_t, level),
+    offsetof(game_state_t, lives),
+    offsetof(game_state_t, num_towers),
+    offsetof(game_state_t, moves),
+    offsetof(game_state_t, selected_tower),
+    offsetof(game_state_t, level_frames),
+    offsetof(game_state_t, level_frames) + 1,
+    offsetof(game_state_t, first_try),
+    offsetof(game_state_t, streak),
+    offsetof(game_state_t, practice)
+};
+const unsigned char save_snap_towers = offsetof(game_state_t, towers);
+const unsigned char save_snap_heights = offsetof(game_state_t, tower_heights);
+
+static unsigned char save_active;
+static unsigned char save_sum1;
+static unsigned char save_sum2;
+
+static const save_level_t save_empty_level = {SAVE_NO_FRAMES, 0, 0};
+
+/* Checksum a bank into save_sum1/save_sum2 (magic taken as SAVE_MAGIC) */
+static void save_checksum(const save_bank_t* bank) {
+    const unsigned char* p = (const unsigned char*)bank;
+    unsigned char i;
+
+    save_sum1 = SAVE_MAGIC;
+    save_sum2 = SAVE_MAGIC;
+    for (i = 1; i < SAVE_SUM_BYTES; i++) {
+        save_sum1 += p[i];
+        save_sum2 += save_sum1;
+    }
+}
+
+static unsigned char save_bank_valid(const save_bank_t* bank) {
+    if (bank->magic != SAVE_MAGIC) {
+        return 0;
+    }
+    save_checksum(bank);
+    return bank->sum1 == save_sum1 && bank->sum2 == save_sum2;
+}
+
+void save_init(void) {
+    unsigned char valid0 = save_bank_valid(&save_bank[0]);
+    unsigned char valid1 = save_bank_valid(&save_bank[1]);
+
+    if (valid0 && valid1) {
+        /* Both intact: the one written last is one sequence step ahead */
+        save_active = ((unsigned char)(save_bank[1].seq - save_bank[0].seq) < 0x80) ? 1 : 0;
+    } else if (valid0) {
+        save_active = 0;
+    } else if (valid1) {
+        save_active = 1;
+    } else {
+        save_active = SAVE_NONE;
+    }
+}
+
+const save_level_t* save_get_level(unsigned char num_towers, unsigned char level) {
+    if (save_active == SAVE_NONE) {
+        return &save_empty_level;
+    }
+    return &save_bank[save_active].level[num_towers - MIN_TOWERS][level - 1];
+}
+
+unsigned char save_best_streak(unsigned char num_towers) {
+    if (save_active == SAVE_NONE) {
+        return 0;
+    }
+    return save_bank[save_active].best_streak[num_towers - MIN_TOWERS];
+}
+
+unsigned char save_record_level(const game_state_t* game) {
+    const save_level_t* best = save_get_level(game->num_towers, game->level);
+    unsigned char mode = game->num_towers - MIN_TOWERS;
+    unsigned char improved = 0;
+    unsigned char target;
+    save_bank_t* dst;
+    save_level_t* rec;
+    unsigned char* to;
+    const unsigned char* from;
+    unsigned char i;
+    unsigned char m;
+
+    if (game->level_frames < best->frames) {
+        improved |= SAVE_NEW_FRAMES;
+    }
+    if (game->lives > best->lives) {
+        improved |= SAVE_NEW_LIVES;
+    }
+    if (game->streak > save_best_streak(game->num_towers)) {
+        improved |= SAVE_NEW_STREAK;
+    }
+    if (!improved && !(game->first_try && best->first_tries < 0xFF)) {
+        return 0;  /* Nothing to store; leave SRAM alone */
+    }
+
+    /* Rebuild the inactive bank; it stays invalid until the magic lands */
+    target = (save_active == 0) ? 1 : 0;
+    dst = &save_bank[target];
+    dst->magic = 0;
+    if (save_active == SAVE_NONE) {
+        for (m = 0; m < SAVE_MODES; m++) {
+            for (i = 0; i < SAVE_LEVELS; i++) {
+                dst->level[m][i] = save_empty_level;
+            }
+            dst->best_streak[m] = 0;
+        }
+        dst->seq = 0;
+    } else {
+        from = (const unsigned char*)&save_bank[save_active];
+        to = (unsigned char*)dst;
+        for (i = 1; i < SAVE_SUM_BYTES; i++) {
+            to[i] = from[i];
+        }
+        dst->seq++;
+    }
+
+    rec = &dst->level[mode][game->level - 1];
+    if (improved & SAVE_NEW_FRAMES) {
+        rec->frames = game->level_frames;
+    }
+    if (improved & SAVE_NEW_LIVES) {
+        rec->lives = game->lives;
+    }
+    if (game->first_try && rec->first_tries < 0xFF) {
+        rec->first_tries++;
+    }
+    if (improved & SAVE_NEW_STREAK) {
+        dst->best_streak[mode] = game->streak;
+    }
+
+    save_checksum(dst);
+    dst->sum1 = save_sum1;
+    dst->sum2 = save_sum2;
+    dst->magic = SAVE_MAGIC;
+    save_active = target;
+
+    return improved;
+}
+
+void save_snapshot(const game_state_t* game, unsigned char state) {
+    if (game->holding_block != 0) {
+        /* A held disk is on no stack: nothing to resume from */
+        save_snap.magic = 0;
+        return;
+    }
+    save_snap.state = state;
+    save_snapshot_copy(game);
+}
+
+unsigned char save_load_snapshot(game_state_t* game, unsigned char* pegs) {
+    const unsigned char* from = &save_snap.level;
+    unsigned char num_blocks;
+    unsigned char sum;
+    unsigned char i;
+
+    if (save_snap.magic != SAVE_SNAP_MAGIC) {
+        return SAVE_NO_SNAPSHOT;
+    }
+    if (save_snap.level == 0 || save_snap.level > MAX_BLOCKS) {
+        return SAVE_NO_SNAPSHOT;
+    }
+    num_blocks = save_snap.level;
+    sum = save_snap.state;
+    for (i = 0; i < SAVE_SNAP_FIELDS; i++) {
+        sum += from[i];
+    }
+    for (i = 0; i < num_blocks; i++) {
+        sum += save_snap.pegs[i];
+    }
+    if (sum != save_snap.sum) {
+        return SAVE_NO_SNAPSHOT;
+    }
+
+    /* Reject anything the game logic could not have produced */
+    if (save_snap.num_towers < MIN_TOWERS || save_snap.num_towers > MAX_TOWERS ||
+        save_snap.lives == 0 || save_snap.selected_tower >= save_snap.num_towers) {
+        return SAVE_NO_SNAPSHOT;
+    }
+    for (i = 0; i < num_blocks; i++) {
+        if (save_snap.pegs[i] >= save_snap.num_towers) {
+            return SAVE_NO_SNAPSHOT;
+        }
+        pegs[i] = save_snap.pegs[i];
+    }
+
+    game->level = save_snap.level;
+    game->lives = save_snap.lives;
+    game->num_towers = save_snap.num_towers;
+    game->moves = save_snap.moves;
+    game->selected_tower = save_snap.selected_tower;
+    game->level_frames = save_snap.level_frames;
+    game->first_try = save_snap.first_try;
+    game->streak = save_snap.streak;
+    game->practice = save_snap.practice;
+    return save_snap.state;
+}
+
+void save_clear_snapshot(void) {
+    save_snap.magic = 0;
+}
+
+void save_export_movelog(const game_state_t* game) {
+    unsigned char sum;
+    unsigned char i;
+
+    save_log.magic = 0;
+    save_log.num_towers = game->num_towers;
+    save_log.level = game->level;
+    save_log.width = movelog_width;
+    save_log.start = movelog_start;
+    save_log.count = movelog_count;
+    sum = game->num_towers + game->level + movelog_width + movelog_start + movelog_count;
+    for (i = 0; i < sizeof(save_log.data); i++) {
+        save_log.data[i] = movelog_data[i];
+        sum += movelog_data[i];
+    }
+    save_log.sum = sum;
+    save_log.magic = SAVE_LOG_MAGIC;
+}
@@ -0,0 +1,66 @@
+#ifndef SAVE_H
+#define SAVE_H
+
+/*
+ * Best records in battery-backed SRAM ($6000, SAVE segment).
+ *
+ * Two banks hold complete copies of the table. A write copies the active
+ * bank into the other one with the change applied, bumps its sequence
+ * number and stores a checksum, and writes the magic byte last as the
+ * commit marker. Power loss mid-write leaves the other bank intact. Boot
+ * validation only reads: one checksum pass per bank, newest valid wins.
+ */
+
+#define SAVE_MODES (MAX_TOWERS - MIN_TOWERS + 1)
+#define SAVE_LEVELS MAX_BLOCKS
+#define SAVE_NO_FRAMES 0xFFFF         /* Level not cleared yet */
+#define SAVE_NO_SNAPSHOT 0xFF         /* save_load_snapshot: nothing to resume */
+
+/* save_record_level result flags */
+#define SAVE_NEW_FRAMES 0x01
+#define SAVE_NEW_LIVES 0x02
+#define SAVE_NEW_STREAK 0x04
+
+typedef struct {
+    unsigned int frames;              /* Fewest gameplay frames to clear */
+    unsigned char lives;              /* Most lives left on clear */
+    unsigned char first_tries;        /* Clears without losing a life (saturates) */
+} save_level_t;
+
+/* Validate both banks and select the newest intact one */
+void save_init(void);
+
+/* Records for a level (1-8) in a peg mode (MIN_TOWERS-MAX_TOWERS) */
+const save_level_t* save_get_level(unsigned char num_towers, unsigned char level);
+
+/* Longest run of first-try clears in a peg mode */
+unsigned char save_best_streak(unsigned char num_towers);
+
+/* Fold a level clear into the table; writes SRAM only if a record improved */
+unsigned char save_record_level(const game_state_t* game);
+
+/*
+ * Resume snapshot: the in-progress game and the main loop state, written
+ * after every completed move, at each level start and as a life is lost
+ * (cleared with the last one). A snapshot only
+ * becomes valid when its magic byte lands, after the data and sum.
+ */
+void save_snapshot(const game_state_t* game, unsigned char state);
+
+/*
+ * Copy a valid snapshot's counters into game and the peg of each disk into
+ * pegs (MAX_BLOCKS bytes) for resume_game(); returns the saved state, or
+ * SAVE_NO_SNAPSHOT
+ */
+unsigned char save_load_snapshot(game_state_t* game, unsigned char* pegs);
+
+/* Drop the snapshot (game over, game won) */
+void save_clear_snapshot(void);
+
+/* Copy the cleared level's move log (ring as-is) to SRAM for host tools */
+void save_export_movelog(const game_state_t* game);
+
+/* Snapshot writer (snapshot.s): scalars and disk pegs; state must already be stored */
+void __fastcall__ save_snapshot_copy(const game_state_t* game);
+
+#endif /* SAVE_H */
@@ -0,0 +1,90 @@
+#include "sched.h"
+#include "region.h"
+
+/* Timer slots; a slot is free when its callback is 0 */
+static sched_callback_t timer_callback[SCHED_MAX_TIMERS];
+static unsigned char timer_remaining[SCHED_MAX_TIMERS];
+static unsigned char timer_period[SCHED_MAX_TIMERS];  /* 0 = one-shot */
+
+static sched_callback_t deferred[SCHED_MAX_DEFERRED];
+static unsigned char deferred_count;
+
+void sched_init(void) {
+    unsigned char i;
+    for (i = 0; i < SCHED_MAX_TIMERS; i++) {
+        timer_callback[i] = 0;
+    }
+    deferred_count = 0;
+}
+
+static unsigned char sched_add(unsigned char frames, unsigned char period, sched_callback_t callback) {
+    unsigned char i;
+
+    if (frames == 0) {
+        frames = 1;
+    }
+
+    for (i = 0; i < SCHED_MAX_TIMERS; i++) {
+        if (timer_callback[i] == 0) {
+            timer_callback[i] = callback;
+            timer_remaining[i] = frames;
+            timer_period[i] = period;
+            return i;
+        }
+    }
+    return SCHED_NONE;  /* All slots busy */
+}
+
+unsigned char sched_after(unsigned char frames, sched_callback_t callback) {
+    return sched_add(frames, 0, callback);
+}
+
+unsigned char sched_every(unsigned char frames, sched_callback_t callback) {
+    return sched_add(frames, frames ? frames : 1, callback);
+}
+
+void sched_defer(sched_callback_t callback) {
+    if (deferred_count < SCHED_MAX_DEFERRED) {
+        deferred[deferred_count] = callback;
+        deferred_count++;
+    }
+}
+
+void sched_cancel(unsigned char slot) {
+    if (slot < SCHED_MAX_TIMERS) {
+        timer_callback[slot] = 0;
+    }
+}
+
+void sched_update(void) {
+    unsigned char i;
+    unsigned char count;
+    sched_callback_t callback;
+
+    /* Deferred callbacks queued by a callback run on the following frame */
+    count = deferred_count;
+    for (i = 0; i < count; i++) {
+        deferred[i]();
+    }
+    for (i = count; i < deferred_count; i++) {
+        deferred[i - count] = deferred[i];
+    }
+    deferred_count -= count;
+
+    for (i = 0; i < SCHED_MAX_TIMERS; i++) {
+        callback = timer_callback[i];
+        if (callback == 0) {
+            continue;
+        }
+        if (timer_remaining[i] > region_ticks) {
+            timer_remaining[i] -= region_ticks;
+            continue;
+        }
+        if (timer_period[i]) {
+            timer_remaining[i] = timer_period[i];
+        } else {
+            timer_callback[i] = 0;  /* Free before calling so the callback can re-arm */
+        }
+        callback();
+    }
+}
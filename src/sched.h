@@ -0,0 +1,33 @@
+#ifndef SCHED_H
+#define SCHED_H
+
+/* Frame scheduler: one-shot/repeating timers and deferred callbacks.
+ * Timers count ticks (NTSC frames, see region.h) so they last as long on
+ * 50 Hz consoles; call sched_update() exactly once per pass of the main
+ * loop, after region_tick(). */
+
+#define SCHED_MAX_TIMERS 4
+#define SCHED_MAX_DEFERRED 4
+#define SCHED_NONE 0xFF
+
+typedef void (*sched_callback_t)(void);
+
+/* Reset all timers and drop any pending deferred callbacks */
+void sched_init(void);
+
+/* Run callback once after the given number of ticks (1-255) */
+unsigned char sched_after(unsigned char frames, sched_callback_t callback);
+
+/* Run callback every given number of ticks until cancelled */
+unsigned char sched_every(unsigned char frames, sched_callback_t callback);
+
+/* Run callback on the next sched_update() */
+void sched_defer(sched_callback_t callback);
+
+/* Cancel a timer returned by sched_after/sched_every (SCHED_NONE is ignored) */
+void sched_cancel(unsigned char slot);
+
+/* Advance all timers by one frame (region_ticks) and run whatever is due */
+void sched_update(void);
+
+#endif /* SCHED_H */
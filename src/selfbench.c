@@ -0,0 +1,173 @@
+#include <time.h>
+#include "nes.h"
+#include "hanoi.h"
+#include "solver.h"
+#include "sprite.h"
+#include "text.h"
+#include "strings.h"
+#include "vram.h"
+#include "region.h"
+#include "palette.h"
+#include "telemetry.h"
+#include "selfbench.h"
+
+#define SPARE_LINES 32  /* Add a move per frame while this much is left over */
+
+/* Results block at a fixed address (see selfbench.h) */
+#pragma bss-name (push, "BENCH")
+selfbench_result_t selfbench_result;
+#pragma bss-name (pop)
+
+/* Scanlines per frame, and frame_idle() iterations per scanline in
+ * 1/16 units (12 cycles each; a line is 113.67 cycles, 106.56 on PAL) */
+static const unsigned int frame_lines[3] = {262, 312, 312};
+static const unsigned char line_iters16[3] = {152, 142, 152};
+
+static game_state_t bench_game;
+static unsigned char moves_per_frame;
+static unsigned int last_tick;  /* NMI count (clock()) at the last vblank */
+
+/* Write value as 5 decimal digit tiles, zero-padded */
+static void format_number(unsigned char* tiles, unsigned int value) {
+    unsigned char i;
+
+    for (i = 5; i != 0; i--) {
+        tiles[i - 1] = 0x10 + (unsigned char)(value % 10);
+        value /= 10;
+    }
+}
+
+static void write_result(unsigned char y, const unsigned char* label, unsigned int value) {
+    unsigned char tiles[5];
+
+    format_number(tiles, value);
+    text_draw(6, y, label);
+    text_draw_tiles(20, y, tiles, sizeof(tiles));
+}
+
+/* Make up to moves_per_frame solver moves; 1 once the level is solved */
+static unsigned char make_moves(void) {
+    unsigned char move;
+    unsigned char made;
+
+    for (made = 0; made < moves_per_frame; made++) {
+        move = solver_next();
+        if (move == SOLVER_DONE) {
+            break;
+        }
+        pickup_block(&bench_game, MOVE_FROM(move));
+        place_block(&bench_game, MOVE_TO(move));
+        selfbench_result.moves++;
+    }
+    if (made > selfbench_result.peak_moves) {
+        selfbench_result.peak_moves = made;
+    }
+    return check_win(&bench_game) != 0;
+}
+
+/* Wait for vblank, timing the frame's work, and adjust the move rate */
+static void end_frame(void) {
+    unsigned int idle = frame_idle();
+    unsigned int tick = (unsigned int)clock();
+    unsigned int elapsed = tick - last_tick;
+    unsigned int lines = frame_lines[region];
+    unsigned int idle_lines;
+
+    last_tick = tick;
+    selfbench_result.frames += elapsed;
+
+    if (elapsed > 1 || idle == 0) {
+        /* Missed a vblank, or reached it with nothing to spare */
+        selfbench_result.lag_frames += (elapsed > 1) ? elapsed - 1 : 1;
+        moves_per_frame = (moves_per_frame + 1) >> 1;
+    } else {
+        idle_lines = (idle << 4) / line_iters16[region];
+        lines = (idle_lines < lines) ? lines - idle_lines : 0;
+        if (idle_lines > SPARE_LINES && moves_per_frame != 0xFF) {
+            moves_per_frame++;
+        }
+    }
+    if (lines > selfbench_result.worst_lines) {
+        selfbench_result.worst_lines = lines;
+    }
+}
+
+/* Solve the current level, one frame at a time */
+static void run_level(void) {
+    unsigned char solved;
+
+    solver_start(bench_game.num_blocks, bench_game.num_towers);
+
+    /* Full redraw with rendering off; not counted, so start on a fresh vblank */
+    render_game_background(&bench_game);
+#ifdef SELFBENCH_HUD_ONLY
+    clear_sprites();
+    PPU_MASK = PPU_MASK_SHOW_BG;
+#else
+    build_game_sprites(&bench_game, 0);
+#endif
+    frame_idle();
+    last_tick = (unsigned int)clock();
+
+    do {
+        /* Vblank: upload what the previous frame prepared */
+        update_sprites();
+        vram_flush();
+        PPU_CTRL = PPU_CTRL_NMI;
+
+        solved = make_moves();
+        render_game_hud(&bench_game);
+#ifndef SELFBENCH_HUD_ONLY
+        build_game_sprites(&bench_game, 0);
+#endif
+        end_frame();
+    } while (!solved);
+
+    /* Show the solved level for its last frame */
+    update_sprites();
+    vram_flush();
+}
+
+void selfbench_run(void) {
+    selfbench_result.done = 0;
+    selfbench_result.region = region;
+    selfbench_result.frames = 0;
+    selfbench_result.lag_frames = 0;
+    selfbench_result.moves = 0;
+    selfbench_result.worst_lines = 0;
+    selfbench_result.peak_moves = 0;
+    moves_per_frame = 1;
+
+    palette_set_bg(COLOR_LIGHT_BLUE);  /* Uploaded by the first level's redraw */
+    init_game(&bench_game, MIN_TOWERS);
+    for (;;) {
+        run_level();
+        if (bench_game.level == MAX_BLOCKS) {
+            break;
+        }
+        bench_game.level++;
+        start_level(&bench_game);
+    }
+    selfbench_result.done = SELFBENCH_DONE;
+
+    /* Results screen */
+    clear_sprites();
+    update_sprites();
+    clear_screen();
+    text_draw(11, 4, str_selfbench);
+    write_result(8, str_frames, selfbench_result.frames);
+    write_result(10, str_lag_frames, selfbench_result.lag_frames);
+    write_result(12, str_worst_lines, selfbench_result.worst_lines);
+    write_result(14, str_moves, selfbench_result.moves);
+    write_result(16, str_peak_per_frame, selfbench_result.peak_moves);
+    palette_upload();
+    PPU_STATUS;
+    PPU_SCROLL = 0;
+    PPU_SCROLL = 0;
+    PPU_CTRL = PPU_CTRL_NMI;
+    PPU_MASK = PPU_MASK_SHOW_BG;
+
+    for (;;) {
+        frame_idle();
+    }
+}
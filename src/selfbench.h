@@ -0,0 +1,33 @@
+#ifndef SELFBENCH_H
+#define SELFBENCH_H
+
+/*
+ * Self-benchmark (make selfbench, built with SELFBENCH defined). Skips the
+ * title and solves levels 1-8 on 3 pegs with the optimal solver, making as
+ * many moves per frame as the spare CPU time allows, then shows the figures
+ * on screen. They also go to a fixed RAM block for the harness and for
+ * debuggers on real hardware. With SELFBENCH_HUD_ONLY, the disks are not
+ * drawn: only the HUD is updated each frame.
+ */
+
+#define SELFBENCH_DONE 0xA5
+
+/* Results block, always at $07F0 (BENCH segment in nes.cfg). Words are
+ * little-endian. */
+typedef struct {
+    unsigned char done;         /* SELFBENCH_DONE once level 8 is solved */
+    unsigned char region;       /* REGION_* the figures were taken on */
+    unsigned int frames;        /* Frames spent in levels, redraws excluded */
+    unsigned int lag_frames;    /* Frames whose work ran into the next vblank */
+    unsigned int moves;         /* Moves made (502 for levels 1-8) */
+    unsigned int worst_lines;   /* Most scanlines of CPU work in one frame */
+    unsigned char peak_moves;   /* Most moves made in one frame */
+} selfbench_result_t;
+
+extern selfbench_result_t selfbench_result;
+
+/* Run the benchmark and show the results; never returns. Call with the
+ * hardware set up (init_nes). */
+void selfbench_run(void);
+
+#endif /* SELFBENCH_H */
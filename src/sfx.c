@@ -1,22 +1,28 @@
 #include "nes.h"
 #include "music.h"
 #include "sfx.h"
+#include "region.h"
 
-static const music_note_t success_sfx[] = {
-    {NOTE_C6, 6},
-    {NOTE_E6, 6},
-    {NOTE_G6, 12},
-    {NOTE_REST, 0}
+static const unsigned char success_sfx_lengths[] = {0, 6, 12};
+static const unsigned char success_sfx_notes[] = {
+    MUSIC_NOTE(NOTE_C6, 1),
+    MUSIC_NOTE(NOTE_E6, 1),
+    MUSIC_NOTE(NOTE_G6, 2),
+    MUSIC_END
 };
 
-static const music_note_t fail_sfx[] = {
-    {NOTE_E3, 10},
-    {NOTE_D3, 10},
-    {NOTE_C3, 20},
-    {NOTE_REST, 0}
+static const unsigned char fail_sfx_lengths[] = {0, 10, 20};
+static const unsigned char fail_sfx_notes[] = {
+    MUSIC_NOTE(NOTE_E3, 1),
+    MUSIC_NOTE(NOTE_D3, 1),
+    MUSIC_NOTE(NOTE_C3, 2),
+    MUSIC_END
 };
 
-static const music_note_t* current_sfx = 0;
+static const music_track_t success_sfx = {success_sfx_notes, success_sfx_lengths};
+static const music_track_t fail_sfx = {fail_sfx_notes, fail_sfx_lengths};
+
+static const music_track_t* current_sfx = 0;
 static unsigned char sfx_index = 0;
 static unsigned char sfx_timer = 0;
 
@@ -29,49 +35,56 @@ void init_sfx(void) {
     sfx_timer = 0;
 }
 
-static void start_sfx(const music_note_t* sfx) {
+static void start_sfx(const music_track_t* sfx) {
     current_sfx = sfx;
     sfx_index = 0;
     sfx_timer = 0;
 }
 
 void play_sfx_success(void) {
-    start_sfx(success_sfx);
+    start_sfx(&success_sfx);
 }
 
 void play_sfx_fail(void) {
-    start_sfx(fail_sfx);
+    start_sfx(&fail_sfx);
 }
 
-void update_sfx(void) {
-    unsigned int note;
-
-    if (current_sfx == 0) {
-        return;
-    }
+/* Advance the effect by one tick */
+static void sfx_tick(void) {
+    unsigned char code;
+    unsigned char note;
 
     if (sfx_timer > 0) {
         sfx_timer--;
         return;
     }
 
-    note = current_sfx[sfx_index].note;
+    code = current_sfx->notes[sfx_index];
 
-    if (note == NOTE_REST && current_sfx[sfx_index].duration == 0) {
+    if (code == MUSIC_END) {
         current_sfx = 0;
         APU_PULSE2_CTRL = 0x30;
         return;
     }
 
+    note = MUSIC_NOTE_INDEX(code);
     if (note == NOTE_REST) {
         APU_PULSE2_CTRL = 0x30;
     } else {
         /* 50% duty, constant volume (louder than music so it's noticeable). */
         APU_PULSE2_CTRL = 0xBF;
-        APU_PULSE2_TIMER_LO = (unsigned char)(note & 0xFF);
-        APU_PULSE2_TIMER_HI = (unsigned char)((note >> 8) & 0x07);
+        APU_PULSE2_TIMER_LO = note_period_lo[note];
+        APU_PULSE2_TIMER_HI = note_period_hi[note];
     }
 
-    sfx_timer = current_sfx[sfx_index].duration;
+    sfx_timer = current_sfx->lengths[MUSIC_LENGTH_INDEX(code)];
     sfx_index++;
 }
+
+void update_sfx(void) {
+    unsigned char ticks;
+
+    for (ticks = region_ticks; ticks != 0 && current_sfx != 0; ticks--) {
+        sfx_tick();
+    }
+}
@@ -0,0 +1,92 @@
+; Resume snapshot writer
+; Called after every completed move, so it has to stay cheap. The stacks are
+; always sorted, so instead of the 32-byte towers array the snapshot keeps
+; the peg of each disk, read off the stacks, plus the scalar fields of
+; game_state_t picked by the offset table in save.c: 20 bytes with an 8-bit
+; running sum, about 500 cycles plus 31 per disk (under 750 at 8 disks). The
+; magic byte is cleared first and written last; a snapshot cut off by a
+; reset is simply not resumed.
+
+.export _save_snapshot_copy
+.import _save_snap, _save_snap_fields, _save_snap_towers, _save_snap_heights
+.importzp ptr1, tmp1, tmp2, tmp3, tmp4
+
+SNAP_MAGIC = $53        ; Must match SAVE_SNAP_MAGIC in save.c
+SNAP_FIELDS = 10        ; Must match SAVE_SNAP_FIELDS in save.c
+MAX_BLOCKS = 8          ; Must match hanoi.h
+MAX_TOWERS = 4
+
+; save_snapshot_t layout (save.c)
+SNAP_MAGIC_OFS = 0
+SNAP_STATE_OFS = 1
+SNAP_FIELDS_OFS = 2
+SNAP_PEGS_OFS = SNAP_FIELDS_OFS + SNAP_FIELDS
+SNAP_SUM_OFS = SNAP_PEGS_OFS + MAX_BLOCKS
+
+.segment "CODE"
+
+; void __fastcall__ save_snapshot_copy(const game_state_t* game);
+; The caller has already stored the state byte; the sum starts from it.
+_save_snapshot_copy:
+    sta ptr1
+    stx ptr1+1
+    lda #$00
+    sta _save_snap+SNAP_MAGIC_OFS
+    lda _save_snap+SNAP_STATE_OFS
+    sta tmp1                ; Running sum
+
+    ; Scalar fields, in save_snap_fields order
+    ldx #$00
+@field:
+    ldy _save_snap_fields,x
+    lda (ptr1),y
+    sta _save_snap+SNAP_FIELDS_OFS,x
+    clc
+    adc tmp1
+    sta tmp1
+    inx
+    cpx #SNAP_FIELDS
+    bne @field
+
+    ; Pegs: every disk on a stack gets that stack's peg number
+    lda #$00
+    sta tmp2                ; Peg
+    lda _save_snap_towers
+    sta tmp3                ; Offset of towers[peg][0]
+@peg:
+    lda _save_snap_heights
+    clc
+    adc tmp2
+    tay
+    lda (ptr1),y            ; tower_heights[peg]
+    beq @next_peg
+    clc
+    adc tmp3
+    sta tmp4                ; One past the top disk
+    ldy tmp3
+@disk:
+    lda (ptr1),y            ; Disk 1-8
+    tax
+    lda tmp2
+    sta _save_snap+SNAP_PEGS_OFS-1,x
+    clc
+    adc tmp1
+    sta tmp1
+    iny
+    cpy tmp4
+    bne @disk
+@next_peg:
+    lda tmp3
+    clc
+    adc #MAX_BLOCKS
+    sta tmp3
+    inc tmp2
+    lda tmp2
+    cmp #MAX_TOWERS
+    bne @peg
+
+    lda tmp1
+    sta _save_snap+SNAP_SUM_OFS
+    lda #SNAP_MAGIC
+    sta _save_snap+SNAP_MAGIC_OFS
+    rts
@@ -0,0 +1,96 @@
+#include "hanoi.h"
+#include "solver.h"
+#include "frame_stewart.h"
+
+/* Deep enough for a 4-peg frame per disk plus the 3-peg frames under it */
+#define SOLVER_DEPTH (2 * MAX_BLOCKS + 2)
+
+/* Frame: disk count (bits 0-3), stage (bits 4-5), 4-peg flag (bit 7) */
+#define FRAME_N(f) ((f) & 0x0F)
+#define FRAME_STAGE(f) (((f) >> 4) & 0x03)
+#define FRAME_FOUR 0x80
+#define FRAME_NEXT_STAGE 0x10
+
+/* Pegs: source (bits 0-1), destination (2-3), spare (4-5), second spare (6-7) */
+#define PEGS(src, dst, spare, spare2) \
+    (unsigned char)((src) | ((dst) << 2) | ((spare) << 4) | ((spare2) << 6))
+#define PEG_SRC(p) ((p) & 0x03)
+#define PEG_DST(p) (((p) >> 2) & 0x03)
+#define PEG_SPARE(p) (((p) >> 4) & 0x03)
+#define PEG_SPARE2(p) (((p) >> 6) & 0x03)
+
+static unsigned char solver_frame[SOLVER_DEPTH];
+static unsigned char solver_pegs[SOLVER_DEPTH];
+static unsigned char solver_depth;
+
+static void solver_push(unsigned char frame, unsigned char pegs) {
+    solver_frame[solver_depth] = frame;
+    solver_pegs[solver_depth] = pegs;
+    solver_depth++;
+}
+
+void solver_start(unsigned char num_blocks, unsigned char num_towers) {
+    solver_depth = 0;
+    if (num_towers == 4) {
+        solver_push(FRAME_FOUR | num_blocks, PEGS(0, 3, 1, 2));
+    } else {
+        solver_push(num_blocks, PEGS(0, 2, 1, 0));
+    }
+}
+
+unsigned char solver_next(void) {
+    unsigned char top;
+    unsigned char frame;
+    unsigned char pegs;
+    unsigned char n;
+    unsigned char k;
+
+    while (solver_depth) {
+        top = solver_depth - 1;
+        frame = solver_frame[top];
+        pegs = solver_pegs[top];
+        n = FRAME_N(frame);
+
+        if (n == 0) {
+            solver_depth--;
+            continue;
+        }
+
+        if (frame & FRAME_FOUR) {
+            /* Park the top k disks on spare using all 4 pegs, move the rest
+             * with 3 pegs (spare is blocked), then bring the k disks over. */
+            k = fs_split[n];
+            switch (FRAME_STAGE(frame)) {
+                case 0:
+                    solver_frame[top] = frame + FRAME_NEXT_STAGE;
+                    solver_push(FRAME_FOUR | k,
+                                PEGS(PEG_SRC(pegs), PEG_SPARE(pegs), PEG_DST(pegs), PEG_SPARE2(pegs)));
+                    break;
+                case 1:
+                    solver_frame[top] = frame + FRAME_NEXT_STAGE;
+                    solver_push(n - k, PEGS(PEG_SRC(pegs), PEG_DST(pegs), PEG_SPARE2(pegs), 0));
+                    break;
+                default:
+                    /* Tail call: replace this frame */
+                    solver_frame[top] = FRAME_FOUR | k;
+                    solver_pegs[top] = PEGS(PEG_SPARE(pegs), PEG_DST(pegs), PEG_SRC(pegs), PEG_SPARE2(pegs));
+                    break;
+            }
+        } else {
+            switch (FRAME_STAGE(frame)) {
+                case 0:
+                    solver_frame[top] = frame + FRAME_NEXT_STAGE;
+                    solver_push(n - 1, PEGS(PEG_SRC(pegs), PEG_SPARE(pegs), PEG_DST(pegs), 0));
+                    break;
+                case 1:
+                    solver_frame[top] = frame + FRAME_NEXT_STAGE;
+                    return MOVE_PACK(PEG_SRC(pegs), PEG_DST(pegs));
+                default:
+                    solver_frame[top] = n - 1;
+                    solver_pegs[top] = PEGS(PEG_SPARE(pegs), PEG_DST(pegs), PEG_SRC(pegs), 0);
+                    break;
+            }
+        }
+    }
+    return SOLVER_DONE;
+}
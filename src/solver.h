@@ -0,0 +1,19 @@
+#ifndef SOLVER_H
+#define SOLVER_H
+
+/*
+ * Optimal move generator. Moves a stack of disks from the leftmost to the
+ * rightmost peg: the classic recursion for 3 pegs, Frame-Stewart for 4 pegs
+ * using the build-time split table (fs_split), so no search runs on the NES.
+ * The recursion is kept on a small explicit stack, one move per call.
+ */
+
+#define SOLVER_DONE 0xFF
+
+/* Begin solving num_blocks disks on num_towers pegs */
+void solver_start(unsigned char num_blocks, unsigned char num_towers);
+
+/* Next move of the optimal solution (MOVE_PACK), or SOLVER_DONE */
+unsigned char solver_next(void);
+
+#endif /* SOLVER_H */
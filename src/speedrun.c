@@ -0,0 +1,154 @@
+#include "hanoi.h"
+#include "speedrun.h"
+#include "vram.h"
+#include "region.h"
+#include "sprite.h"
+
+unsigned char speedrun_time[SPEEDRUN_BYTES];
+unsigned char speedrun_splits[MAX_BLOCKS][SPEEDRUN_BYTES];
+unsigned char speedrun_running;
+unsigned char speedrun_resumed;
+static unsigned char speedrun_fps;  /* BCD frames per second */
+#ifdef SPRITE_HUD
+static unsigned char hud_minutes;   /* BCD minutes in the nametable */
+#endif
+
+void speedrun_start(void) {
+    unsigned char i;
+
+    for (i = 0; i < SPEEDRUN_BYTES; i++) {
+        speedrun_time[i] = 0;
+    }
+    for (i = 0; i < MAX_BLOCKS; i++) {
+        speedrun_splits[i][SPEEDRUN_FRAMES] = 0;
+        speedrun_splits[i][SPEEDRUN_SECONDS] = 0;
+        speedrun_splits[i][SPEEDRUN_MINUTES] = 0;
+    }
+    speedrun_fps = (region == REGION_NTSC) ? 0x60 : 0x50;
+    speedrun_running = 1;
+    speedrun_resumed = 0;
+}
+
+void speedrun_resume(unsigned char level) {
+    unsigned char i;
+
+    speedrun_start();
+    for (i = 0; i < level - 1; i++) {
+        speedrun_splits[i][SPEEDRUN_MINUTES] = SPEEDRUN_NO_SPLIT;
+    }
+    speedrun_resumed = 1;
+}
+
+/*
+ * BCD increment with a carry chain that stops at the first digit pair that
+ * does not wrap, so a frame costs one add and a compare or two: 59 frames
+ * in 60 never touch the seconds.
+ */
+void speedrun_tick(void) {
+    unsigned char v;
+
+    if (!speedrun_running) {
+        return;
+    }
+
+    v = speedrun_time[SPEEDRUN_FRAMES] + 1;
+    if ((v & 0x0F) == 0x0A) {
+        v += 0x06;
+    }
+    if (v != speedrun_fps) {
+        speedrun_time[SPEEDRUN_FRAMES] = v;
+        return;
+    }
+    speedrun_time[SPEEDRUN_FRAMES] = 0;
+
+    v = speedrun_time[SPEEDRUN_SECONDS] + 1;
+    if ((v & 0x0F) == 0x0A) {
+        v += 0x06;
+    }
+    if (v != 0x60) {
+        speedrun_time[SPEEDRUN_SECONDS] = v;
+        return;
+    }
+    speedrun_time[SPEEDRUN_SECONDS] = 0;
+
+    v = speedrun_time[SPEEDRUN_MINUTES] + 1;
+    if ((v & 0x0F) == 0x0A) {
+        v += 0x06;
+    }
+    if (v == 0xA0) {
+        /* Out of digits: hold at 99:59:59 */
+        speedrun_time[SPEEDRUN_FRAMES] = speedrun_fps - 0x07;  /* BCD fps - 1 */
+        speedrun_time[SPEEDRUN_SECONDS] = 0x59;
+        speedrun_running = 0;
+        return;
+    }
+    speedrun_time[SPEEDRUN_MINUTES] = v;
+}
+
+void speedrun_split(unsigned char level) {
+    unsigned char* split = speedrun_splits[level - 1];
+
+    split[SPEEDRUN_FRAMES] = speedrun_time[SPEEDRUN_FRAMES];
+    split[SPEEDRUN_SECONDS] = speedrun_time[SPEEDRUN_SECONDS];
+    split[SPEEDRUN_MINUTES] = speedrun_time[SPEEDRUN_MINUTES];
+}
+
+#ifdef SPRITE_HUD
+void speedrun_queue_hud(void) {
+    sprite_t* sprite = &oam_buffer[HUD_SPRITE_TIME];
+    unsigned char* dst;
+
+    sprite[0].tile = 0x10 + (speedrun_time[SPEEDRUN_SECONDS] >> 4);
+    sprite[1].tile = 0x10 + (speedrun_time[SPEEDRUN_SECONDS] & 0x0F);
+    sprite[2].tile = 0x10 + (speedrun_time[SPEEDRUN_FRAMES] >> 4);
+    sprite[3].tile = 0x10 + (speedrun_time[SPEEDRUN_FRAMES] & 0x0F);
+
+    /* Minutes: once a minute; retried next frame if the queue is full */
+    if (speedrun_time[SPEEDRUN_MINUTES] == hud_minutes) {
+        return;
+    }
+    dst = vram_begin(SPEEDRUN_HUD_ADDR, 3);
+    if (dst != 0) {
+        dst[0] = 0x10 + (speedrun_time[SPEEDRUN_MINUTES] >> 4);
+        dst[1] = 0x10 + (speedrun_time[SPEEDRUN_MINUTES] & 0x0F);
+        dst[2] = 0x3A;  /* : */
+        hud_minutes = speedrun_time[SPEEDRUN_MINUTES];
+    }
+}
+
+void speedrun_redraw_hud(void) {
+    unsigned char i;
+
+    /* Seconds and frames sprites over cells the redraw left blank */
+    for (i = 0; i < 2; i++) {
+        sprite_hud_place(HUD_SPRITE_TIME + i, SPEEDRUN_HUD_COL + 3 + i, SPEEDRUN_HUD_ROW);
+        sprite_hud_place(HUD_SPRITE_TIME + 2 + i, SPEEDRUN_HUD_COL + 6 + i, SPEEDRUN_HUD_ROW);
+    }
+    vram_put(SPEEDRUN_HUD_ADDR + 5, 0x3A);  /* The second colon never changes */
+    hud_minutes = 0xFF;                     /* Not BCD: forces "MM:" */
+    speedrun_queue_hud();
+}
+#else
+void speedrun_queue_hud(void) {
+    unsigned char* dst = vram_begin(SPEEDRUN_HUD_ADDR, SPEEDRUN_TEXT_LEN);
+
+    if (dst != 0) {
+        speedrun_format(dst, speedrun_time);
+    }
+}
+
+void speedrun_redraw_hud(void) {
+    speedrun_queue_hud();
+}
+#endif
+
+void speedrun_format(unsigned char* tiles, const unsigned char* bcd) {
+    tiles[0] = 0x10 + (bcd[SPEEDRUN_MINUTES] >> 4);
+    tiles[1] = 0x10 + (bcd[SPEEDRUN_MINUTES] & 0x0F);
+    tiles[2] = 0x3A;  /* : */
+    tiles[3] = 0x10 + (bcd[SPEEDRUN_SECONDS] >> 4);
+    tiles[4] = 0x10 + (bcd[SPEEDRUN_SECONDS] & 0x0F);
+    tiles[5] = 0x3A;
+    tiles[6] = 0x10 + (bcd[SPEEDRUN_FRAMES] >> 4);
+    tiles[7] = 0x10 + (bcd[SPEEDRUN_FRAMES] & 0x0F);
+}
@@ -0,0 +1,54 @@
+#ifndef SPEEDRUN_H
+#define SPEEDRUN_H
+
+/*
+ * Speedrun timer. Counts every frame from STATE_GAMEPLAY entry until the
+ * run ends, kept as packed BCD (minutes:seconds:frames, 60 frames to the
+ * second, 50 on PAL and Dendy) so the HUD shows it without any division.
+ * Real frames are counted, not ticks, so the clock stays frame-accurate.
+ * A split is taken at each level clear. A run resumed from a snapshot is
+ * timed from the reset: the time before it is lost, so the run is marked.
+ */
+
+#define SPEEDRUN_FRAMES 0             /* BCD 00-59 (00-49 at 50 Hz) */
+#define SPEEDRUN_SECONDS 1            /* BCD 00-59 */
+#define SPEEDRUN_MINUTES 2            /* BCD 00-99, stops at 99:59:59 */
+#define SPEEDRUN_BYTES 3
+#define SPEEDRUN_NO_SPLIT 0xFF        /* In SPEEDRUN_MINUTES: level not timed */
+
+#define SPEEDRUN_HUD_COL 19            /* "MM:SS:FF" after TIME */
+#define SPEEDRUN_HUD_ROW 3
+#define SPEEDRUN_HUD_ADDR (0x2000 + (SPEEDRUN_HUD_ROW * 32) + SPEEDRUN_HUD_COL)
+#define SPEEDRUN_TEXT_LEN 8
+
+extern unsigned char speedrun_time[SPEEDRUN_BYTES];
+extern unsigned char speedrun_splits[MAX_BLOCKS][SPEEDRUN_BYTES];  /* Run time at each level clear */
+extern unsigned char speedrun_running;
+extern unsigned char speedrun_resumed;  /* Timed from a resume, not from level 1 */
+
+/* Zero the clock and splits and start counting at the region frame rate */
+void speedrun_start(void);
+
+/* speedrun_start() for a game resumed at level (1-8): earlier levels get no split */
+void speedrun_resume(unsigned char level);
+
+/* Advance one frame if running */
+void speedrun_tick(void);
+
+/* Record the split for a level (1-8) */
+void speedrun_split(unsigned char level);
+
+/*
+ * Queue the current time for the HUD (8 tiles, next vblank). SPRITE_HUD
+ * builds set the seconds and frames sprites instead and queue "MM:" only
+ * when the minutes change.
+ */
+void speedrun_queue_hud(void);
+
+/* speedrun_queue_hud() after a full redraw: the whole field is rewritten */
+void speedrun_redraw_hud(void);
+
+/* Format a BCD time as "MM:SS:FF" tiles (SPEEDRUN_TEXT_LEN bytes) */
+void speedrun_format(unsigned char* tiles, const unsigned char* bcd);
+
+#endif /* SPEEDRUN_H */
@@ -0,0 +1,10 @@
+#ifndef SPLIT_H
+#define SPLIT_H
+
+/* Wait for the sprite 0 hit on the HUD divider, then scroll the rest of
+ * the frame horizontally by x pixels (0-511). Call once per frame after
+ * vblank work, with sprite 0 in OAM and rendering on. Returns 0 if vblank
+ * arrived without a hit. */
+unsigned char __fastcall__ split_scroll(unsigned int x);
+
+#endif /* SPLIT_H */
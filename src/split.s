@@ -0,0 +1,79 @@
+; Sprite-0-hit raster split
+; The HUD rows above the divider always show nametable $2000 at scroll 0,0
+; (set during vblank); the playfield below scrolls horizontally across both
+; nametables. Sprite 0 sits on the divider at X=248, so the hit is seen on
+; the divider's first opaque line between dots ~250 and ~271. The writes
+; below then land before dot 341 of the same line and are copied into the
+; PPU at dot 257 of the next line, every frame: no visible jitter.
+;
+; That holds while the main loop calls in before the divider is drawn: at
+; most ~7,600 cycles after the vblank flag on NTSC (20 vblank lines, the
+; pre-render line and 46 HUD lines; PAL and Dendy allow more). The uploads
+; must fit the 2,273-cycle NTSC vblank; audio, timers and telemetry get the
+; rest. A later call misses the split for that frame.
+;
+; Both waits poll bit 6 only and share one budget of SPLIT_TIMEOUT * 256
+; iterations (~16,900 cycles), which reaches the divider on every region
+; (~12,400 cycles after the flag on PAL) and, for a call within the first
+; ~12,800 cycles after the flag, gives up before the next vblank: reading
+; $2002 as the vblank flag sets would clear it, and wait_vblank would miss
+; the frame.
+
+.export _split_scroll
+.importzp tmp1
+
+PPU_CTRL   = $2000
+PPU_STATUS = $2002
+PPU_SCROLL = $2005
+
+PPU_CTRL_NMI = $80
+
+SPLIT_TIMEOUT = 6       ; x 256 iterations of 11 cycles
+
+.segment "CODE"
+
+; unsigned char __fastcall__ split_scroll(unsigned int x);
+; A = scroll X (low byte), X bit 0 = start in the right nametable.
+; Returns 1 once the scroll is set, 0 if the budget ran out (no hit, or
+; called after the divider).
+_split_scroll:
+    sta tmp1
+    txa
+    and #$01
+    ora #PPU_CTRL_NMI   ; Kept in A through the waits
+    ldx #$00
+    ldy #SPLIT_TIMEOUT
+
+    ; The hit flag from the previous frame clears at the pre-render line
+@wait_clear:
+    bit PPU_STATUS
+    bvc @wait_hit
+    dex
+    bne @wait_clear
+    dey
+    bne @wait_clear
+    beq @no_hit
+
+@wait_hit:
+    bit PPU_STATUS
+    bvs @hit
+    dex
+    bne @wait_hit
+    dey
+    bne @wait_hit
+    beq @no_hit
+
+@hit:
+    sta PPU_CTRL        ; Nametable select (bit 8 of scroll X)
+    lda tmp1
+    sta PPU_SCROLL      ; Coarse + fine X
+    lda #$00
+    sta PPU_SCROLL      ; Y is not reloaded until the next frame
+    ldx #$00
+    lda #$01
+    rts
+
+@no_hit:
+    ldx #$00
+    txa
+    rts
@@ -6,6 +6,12 @@
 sprite_t oam_buffer[64];
 #pragma bss-name(pop)
 
+unsigned char sprite_pool_next;
+unsigned char sprite_pool_free;
+unsigned char sprite_pool_first;
+unsigned char sprite_pool_end;
+static unsigned char sprite_rotation;
+
 /* Clear all sprites (move them offscreen) */
 void clear_sprites(void) {
     unsigned char i;
@@ -17,6 +23,16 @@ void clear_sprites(void) {
     }
 }
 
+#ifdef SPRITE_HUD
+void sprite_hud_place(unsigned char slot, unsigned char col, unsigned char row) {
+    oam_buffer[slot].y = (unsigned char)(row * 8 - 1);  /* OAM Y is one line early */
+    oam_buffer[slot].tile = 0x00;
+    oam_buffer[slot].attributes = SPRITE_PALETTE_3;
+    oam_buffer[slot].x = (unsigned char)(col * 8);
+}
+#endif
+
+#ifndef UNITY_BUILD
 /* Update OAM with DMA transfer */
 void update_sprites(void) {
     /* Set OAM address to 0 */
@@ -26,3 +42,43 @@ void update_sprites(void) {
     /* DMA transfers 256 bytes from $xx00 to OAM */
     OAM_DMA = (unsigned char)((unsigned int)oam_buffer >> 8);
 }
+#endif
+
+void sprite_pool_reset(void) {
+    unsigned char i;
+
+    for (i = FIRST_GAME_SPRITE; i < 64; i++) {
+        oam_buffer[i].y = 0xFF;  /* Offscreen */
+    }
+    sprite_pool_next = FIRST_GAME_SPRITE;
+    sprite_pool_first = FIRST_GAME_SPRITE;
+    sprite_pool_end = 64;
+    sprite_pool_free = 64 - FIRST_GAME_SPRITE;
+}
+
+void sprite_pool_rotate(unsigned char count) {
+    unsigned char offset;
+
+    if (count > sprite_pool_free) {
+        count = sprite_pool_free;  /* The rest won't get slots anyway */
+    }
+    sprite_pool_first = sprite_pool_next;
+    sprite_pool_end = sprite_pool_next + count;
+    if (count == 0) {
+        return;
+    }
+
+    sprite_rotation += SPRITE_ROTATE_STEP;
+    offset = sprite_rotation;
+    while (offset >= count) {
+        offset -= count;
+    }
+    sprite_pool_next += offset;
+}
+
+void sprite_pool_redraw(unsigned char first, unsigned char count) {
+    sprite_pool_next = first;
+    sprite_pool_first = first;
+    sprite_pool_end = 64;
+    sprite_pool_free = count;
+}
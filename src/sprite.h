@@ -9,13 +9,69 @@ typedef struct {
     unsigned char x;          /* X position */
 } sprite_t;
 
+/* Slot 0 is the sprite-0-hit marker for the HUD split (src/split.s) */
+#define SPRITE0_SLOT 0
+
+#ifdef SPRITE_HUD
+/*
+ * Sprite HUD (make SPRITE_HUD=1): the moves counter and the clock's seconds
+ * and frames are digit sprites over blank nametable cells, so a gameplay
+ * frame changes a tile number instead of queueing VRAM. All seven sit on
+ * HUD row 3, one under the per-scanline limit; the clock's minutes and
+ * colons stay in the nametable.
+ */
+#define HUD_SPRITE_MOVES 1           /* 3 slots: hundreds, tens, ones */
+#define HUD_SPRITE_TIME 4            /* 4 slots: seconds, then frames */
+#define HUD_SPRITES 7
+#define FIRST_GAME_SPRITE (HUD_SPRITE_MOVES + HUD_SPRITES)
+#else
+#define FIRST_GAME_SPRITE 1
+#endif
+
 /* OAM buffer (64 sprites max) */
 extern sprite_t oam_buffer[64];
 
+/*
+ * Sprite pool. Slots below FIRST_GAME_SPRITE are reserved (sprite 0 and
+ * any HUD sprites) and survive sprite_pool_reset().
+ * After sprite_pool_reset(), sprites drawn first are priority sprites and
+ * get fixed slots in draw order, so they always win a crowded scanline.
+ * sprite_pool_rotate() turns the next `count` slots into a ring whose start
+ * moves every call; redrawing a crowded scene each frame then shows its
+ * excess sprites as flicker instead of dropping the same ones for good.
+ * draw_metasprite() takes its slots from here.
+ */
+#define SPRITES_PER_LINE 8           /* PPU limit per scanline */
+#define SPRITE_ROTATE_STEP 7         /* Ring start advance per rotation */
+
+extern unsigned char sprite_pool_next;   /* Next slot to fill */
+extern unsigned char sprite_pool_free;   /* Slots left */
+extern unsigned char sprite_pool_first;  /* Ring: first slot */
+extern unsigned char sprite_pool_end;    /* Ring: one past the last slot */
+
+/* Hide every game sprite and make all slots after the reserved ones free */
+void sprite_pool_reset(void);
+
+/* Start a rotating ring for the next `count` sprites */
+void sprite_pool_rotate(unsigned char count);
+
+/* Redraw `count` priority sprites in place, starting at `first` */
+void sprite_pool_redraw(unsigned char first, unsigned char count);
+
 /* Clear all sprites */
 void clear_sprites(void);
 
+#ifdef SPRITE_HUD
+/* Put a HUD sprite over nametable cell (col, row), blank, palette 3 (white) */
+void sprite_hud_place(unsigned char slot, unsigned char col, unsigned char row);
+#endif
+
 /* Update OAM (call during vblank) */
+#ifdef UNITY_BUILD
+#define update_sprites() (OAM_ADDR = 0x00, \
+                          OAM_DMA = (unsigned char)((unsigned int)oam_buffer >> 8))
+#else
 void update_sprites(void);
+#endif
 
 #endif /* SPRITE_H */
@@ -0,0 +1,140 @@
+#include <time.h>
+#include "nes.h"
+#include "hanoi.h"
+#include "region.h"
+#include "telemetry.h"
+
+#define TELEMETRY_MAGIC 0x54
+#define TELEMETRY_SUM_BYTES (sizeof(telemetry_record_t) - 2)
+
+#pragma bss-name (push, "SAVE")
+telemetry_record_t telemetry_ring[TELEMETRY_RECORDS];
+#pragma bss-name (pop)
+
+unsigned int telemetry_idle;
+
+static telemetry_record_t telemetry_now;  /* Counters since the last flush */
+static unsigned char telemetry_slot;      /* Ring slot of the next record */
+static unsigned char telemetry_skip;      /* Passes left out of the timing figures */
+static unsigned int telemetry_tick;       /* NMI count (clock()) at the last frame */
+static unsigned char telemetry_sum1;
+static unsigned char telemetry_sum2;
+
+/* Checksum a record into telemetry_sum1/telemetry_sum2 (magic taken as
+ * TELEMETRY_MAGIC) */
+static void telemetry_checksum(const telemetry_record_t* rec) {
+    const unsigned char* p = (const unsigned char*)rec;
+    unsigned char i;
+
+    telemetry_sum1 = TELEMETRY_MAGIC;
+    telemetry_sum2 = TELEMETRY_MAGIC;
+    for (i = 1; i < TELEMETRY_SUM_BYTES; i++) {
+        telemetry_sum1 += p[i];
+        telemetry_sum2 += telemetry_sum1;
+    }
+}
+
+/* Start a new period of counters */
+static void telemetry_reset(void) {
+    unsigned char i;
+
+    telemetry_now.region = region;
+    telemetry_now.frames = 0;
+    telemetry_now.lag_frames = 0;
+    telemetry_now.overruns = 0;
+    telemetry_now.min_idle = 0xFFFF;
+    for (i = 0; i < MAX_BLOCKS; i++) {
+        telemetry_now.level_frames[i] = 0;
+        telemetry_now.level_clears[i] = 0;
+    }
+}
+
+void telemetry_init(void) {
+    const telemetry_record_t* rec;
+    unsigned char newest = TELEMETRY_RECORDS;
+    unsigned char i;
+
+    for (i = 0; i < TELEMETRY_RECORDS; i++) {
+        rec = &telemetry_ring[i];
+        if (rec->magic != TELEMETRY_MAGIC) {
+            continue;
+        }
+        telemetry_checksum(rec);
+        if (rec->sum1 != telemetry_sum1 || rec->sum2 != telemetry_sum2) {
+            continue;
+        }
+        if (newest == TELEMETRY_RECORDS ||
+            (unsigned char)(rec->seq - telemetry_ring[newest].seq) < 0x80) {
+            newest = i;
+        }
+    }
+
+    if (newest == TELEMETRY_RECORDS) {
+        telemetry_slot = 0;
+        telemetry_now.seq = 0;
+    } else {
+        telemetry_slot = (newest + 1) % TELEMETRY_RECORDS;
+        telemetry_now.seq = telemetry_ring[newest].seq + 1;
+    }
+    telemetry_reset();
+    telemetry_skip = 1;  /* The first pass times the boot */
+}
+
+/* Write the current counters as the next ring record */
+static void telemetry_flush(void) {
+    telemetry_record_t* rec = &telemetry_ring[telemetry_slot];
+    const unsigned char* src = (const unsigned char*)&telemetry_now;
+    unsigned char* dst = (unsigned char*)rec;
+    unsigned char i;
+
+    rec->magic = 0;
+    for (i = 1; i < TELEMETRY_SUM_BYTES; i++) {
+        dst[i] = src[i];
+    }
+    telemetry_checksum(rec);
+    rec->sum1 = telemetry_sum1;
+    rec->sum2 = telemetry_sum2;
+    rec->magic = TELEMETRY_MAGIC;
+
+    telemetry_slot = (telemetry_slot + 1) % TELEMETRY_RECORDS;
+    telemetry_now.seq++;
+    telemetry_reset();
+}
+
+void telemetry_update(void) {
+    unsigned int tick = (unsigned int)clock();
+    unsigned int elapsed = tick - telemetry_tick;
+
+    telemetry_tick = tick;
+    telemetry_now.frames += elapsed;
+    if (telemetry_skip != 0) {
+        telemetry_skip--;
+    } else {
+        if (elapsed > 1) {
+            telemetry_now.lag_frames += elapsed - 1;
+        }
+        if (telemetry_idle == 0) {
+            telemetry_now.overruns++;
+        } else if (telemetry_idle < telemetry_now.min_idle) {
+            telemetry_now.min_idle = telemetry_idle;
+        }
+    }
+
+    if (telemetry_now.frames >= TELEMETRY_FLUSH_FRAMES) {
+        telemetry_flush();
+    }
+}
+
+void telemetry_resync(void) {
+    /* This pass and the next, whose vblank wait the redraw delayed */
+    telemetry_skip = 2;
+}
+
+void telemetry_level(unsigned char level, unsigned int frames) {
+    unsigned int* total = &telemetry_now.level_frames[level - 1];
+
+    *total = (frames > 0xFFFF - *total) ? 0xFFFF : *total + frames;
+    if (telemetry_now.level_clears[level - 1] != 0xFF) {
+        telemetry_now.level_clears[level - 1]++;
+    }
+}
@@ -0,0 +1,55 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+/*
+ * Field performance telemetry. The main loop keeps cheap per-frame
+ * counters (frames whose work missed a vblank, frames that ran into vblank,
+ * the least spare time before a vblank, frames per level clear); every
+ * TELEMETRY_FLUSH_FRAMES frames they go to SRAM as one record of a ring and
+ * start again. Records carry a Fletcher-16 sum and a magic byte written
+ * last, like the save banks, so a cut-off write is simply skipped.
+ * tools/telemetry_dump.py reads the ring from a .sav file.
+ */
+
+#define TELEMETRY_RECORDS 16
+#define TELEMETRY_FLUSH_FRAMES 3600   /* One minute at 60 Hz */
+
+/* Layout is read by tools/telemetry_dump.py: keep them in step. Words are
+ * little-endian. */
+typedef struct {
+    unsigned char magic;              /* Written last: commit marker */
+    unsigned char seq;                /* Record number, wrapping; newest wins */
+    unsigned char region;             /* REGION_* */
+    unsigned int frames;              /* Frames covered */
+    unsigned int lag_frames;          /* Frames whose work missed the next vblank */
+    unsigned int overruns;            /* Frames whose work ran into vblank */
+    unsigned int min_idle;            /* Least frame_idle() count: the worst frame */
+    unsigned int level_frames[MAX_BLOCKS];  /* Frames spent on clears, by level */
+    unsigned char level_clears[MAX_BLOCKS]; /* Clears by level */
+    unsigned char sum1;               /* Fletcher-16 over magic..level_clears */
+    unsigned char sum2;
+} telemetry_record_t;
+
+extern telemetry_record_t telemetry_ring[TELEMETRY_RECORDS];
+
+/* frame_idle() count of the frame that just ended (wait_vblank stores it) */
+extern unsigned int telemetry_idle;
+
+/* Find the newest intact record; the next flush goes after it */
+void telemetry_init(void);
+
+/* Account for the frame that just ended; call once per main loop pass.
+ * Writes a record every TELEMETRY_FLUSH_FRAMES frames. */
+void telemetry_update(void);
+
+/* This pass makes a full-screen redraw: leave it out of the timing figures */
+void telemetry_resync(void);
+
+/* A level (1-8) was cleared in the given number of frames */
+void telemetry_level(unsigned char level, unsigned int frames);
+
+/* CPU loop iterations (12 cycles each) from the call to the next vblank
+ * flag; 0 if the flag is already set (idle_timer.s) */
+unsigned int __fastcall__ frame_idle(void);
+
+#endif /* TELEMETRY_H */
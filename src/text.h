@@ -1,19 +1,24 @@
 #ifndef TEXT_H
 #define TEXT_H
 
-/* ASCII to tile mappings for text rendering */
-/* Our CHR ROM has simplified character set starting at tile $10 for '0' */
+/* Text is built at compile time by tools/gen_strings.py (strings.h): each
+ * string is a length byte followed by tile indices, so drawing it is a
+ * straight copy. Positions are tiles on nametable $2000. */
 
-/* Convert ASCII character to tile number */
-unsigned char ascii_to_tile(char c);
+#define TEXT_ADDR(x, y) (0x2000 + ((unsigned int)(y) * 32) + (x))
 
-/* Set background color */
-void set_bg_color(unsigned char color);
+/* Write a tile string to the nametable now (rendering must be off) */
+void text_draw(unsigned char x, unsigned char y, const unsigned char* str);
 
-/* Write a string to the nametable at given position */
-void write_text(unsigned char x, unsigned char y, const char* text);
+/* Write len tiles built at runtime (digits, times) now (rendering must be off) */
+void text_draw_tiles(unsigned char x, unsigned char y, const unsigned char* tiles, unsigned char len);
 
-/* Clear the screen (fill with tile 0) */
+/* Queue a tile string for the next vblank, rendering left on. Returns 0 if
+ * the VRAM queue is full (nothing queued). */
+unsigned char text_queue(unsigned char x, unsigned char y, const unsigned char* str);
+
+/* Clear the screen (fill with tile 0); leaves rendering off for the
+ * caller's draws */
 void clear_screen(void);
 
 /* Update the screen (copy buffer to PPU) */
@@ -0,0 +1,64 @@
+#include "nes.h"
+#include "vram.h"
+
+/* Runs are stored as: addr_hi, addr_lo, len, data[len] */
+static unsigned char vram_queue[VRAM_QUEUE_SIZE];
+static unsigned char vram_queue_len;
+
+unsigned char* vram_begin(unsigned int addr, unsigned char len) {
+    unsigned char* run;
+
+    if ((unsigned int)vram_queue_len + 3 + len > VRAM_QUEUE_SIZE) {
+        return 0;  /* Queue full; drop the update */
+    }
+
+    run = &vram_queue[vram_queue_len];
+    run[0] = (unsigned char)(addr >> 8);
+    run[1] = (unsigned char)(addr & 0xFF);
+    run[2] = len;
+    vram_queue_len += 3 + len;
+    return run + 3;
+}
+
+void vram_write(unsigned int addr, const unsigned char* data, unsigned char len) {
+    unsigned char* dst = vram_begin(addr, len);
+    unsigned char i;
+
+    if (dst == 0) {
+        return;
+    }
+    for (i = 0; i < len; i++) {
+        dst[i] = data[i];
+    }
+}
+
+void vram_put(unsigned int addr, unsigned char value) {
+    unsigned char* dst = vram_begin(addr, 1);
+
+    if (dst != 0) {
+        *dst = value;
+    }
+}
+
+void vram_flush(void) {
+    unsigned char i = 0;
+    unsigned char len;
+
+    while (i < vram_queue_len) {
+        PPU_STATUS;
+        PPU_ADDR = vram_queue[i];
+        PPU_ADDR = vram_queue[i + 1];
+        len = vram_queue[i + 2];
+        i += 3;
+        while (len) {
+            PPU_DATA = vram_queue[i];
+            i++;
+            len--;
+        }
+    }
+    vram_queue_len = 0;
+
+    PPU_STATUS;
+    PPU_SCROLL = 0;
+    PPU_SCROLL = 0;
+}
@@ -0,0 +1,23 @@
+#ifndef VRAM_H
+#define VRAM_H
+
+/* VRAM update queue: nametable/attribute writes are prepared during the
+ * frame and copied to the PPU in one pass at the start of the next vblank. */
+
+#define VRAM_QUEUE_SIZE 64
+
+/* Queue a run of bytes starting at a PPU address (len <= 32) */
+void vram_write(unsigned int addr, const unsigned char* data, unsigned char len);
+
+/* Queue a single byte */
+void vram_put(unsigned int addr, unsigned char value);
+
+/* Reserve a run of len bytes at addr and return a pointer to fill in,
+ * or 0 if the queue is full. */
+unsigned char* vram_begin(unsigned int addr, unsigned char len);
+
+/* Copy all queued runs to the PPU and empty the queue (call during vblank
+ * or with rendering disabled). Leaves the scroll at 0,0. */
+void vram_flush(void);
+
+#endif /* VRAM_H */
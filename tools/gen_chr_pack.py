@@ -0,0 +1,96 @@
+#!/usr/bin/env python3
+"""Pack the CHR-ROM tiles for the CHR-RAM board (make chrram).
+
+Reads the tile data in src/chr_rom.s (.byte and .res lines) and
+writes it as a tile stream that src/chr_unpack.s copies into CHR-RAM at
+boot. Each tile starts with a mode byte:
+
+    $01  plane 1 = plane 0       8 bytes follow
+    $02  plane 1 all zero        8 bytes follow (plane 0)
+    $03  plane 0 all zero        8 bytes follow (plane 1)
+    $04  raw                     16 bytes follow
+    $80+n  n blank tiles (1-127), no data
+    $FF  end
+
+Tiles after the last non-blank one are not written at all: nothing on
+screen uses them, and clearing them would only cost boot time.
+
+Writes a ca65 source file (RODATA).
+"""
+
+import argparse
+import re
+
+CHR_SIZE = 0x2000
+TILE = 16
+
+CHR_COPY, CHR_LO, CHR_HI, CHR_RAW = 1, 2, 3, 4
+CHR_BLANK_RUN, CHR_END = 0x80, 0xFF
+
+
+def read_chr(path):
+    data = []
+    for line in open(path):
+        line = line.split(";", 1)[0].strip()
+        if line.startswith(".byte"):
+            data.extend(int(v.strip().lstrip("$"), 16) for v in line[5:].split(","))
+        elif line.startswith(".res"):
+            args = [int(re.sub(r"^\$", "0x", v.strip()), 0) for v in line[4:].split(",")]
+            data.extend([args[1] if len(args) > 1 else 0] * args[0])
+    assert len(data) <= CHR_SIZE, "chr_rom.s holds more than 8KB"
+    return data + [0] * (CHR_SIZE - len(data))
+
+
+def pack(data):
+    tiles = [data[i:i + TILE] for i in range(0, CHR_SIZE, TILE)]
+    while tiles and not any(tiles[-1]):
+        tiles.pop()
+
+    out = []
+    blank = 0
+    for t in tiles + [None]:
+        if t is not None and not any(t):
+            blank += 1
+            if blank == 0x7F:
+                out.append(CHR_BLANK_RUN | blank)
+                blank = 0
+            continue
+        if blank:
+            out.append(CHR_BLANK_RUN | blank)
+            blank = 0
+        if t is None:
+            break
+        lo, hi = t[:8], t[8:]
+        if lo == hi:
+            out += [CHR_COPY] + lo
+        elif not any(hi):
+            out += [CHR_LO] + lo
+        elif not any(lo):
+            out += [CHR_HI] + hi
+        else:
+            out += [CHR_RAW] + t
+    out.append(CHR_END)
+    return out, len(tiles)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--chr", required=True, help="src/chr_rom.s")
+    parser.add_argument("--asm", required=True, help="ca65 output file")
+    args = parser.parse_args()
+
+    packed, tiles = pack(read_chr(args.chr))
+
+    with open(args.asm, "w") as out:
+        out.write("; Generated by tools/gen_chr_pack.py - do not edit\n")
+        out.write("; %d tiles (%d bytes) packed into %d bytes\n\n"
+                  % (tiles, tiles * TILE, len(packed)))
+        out.write(".export _chr_pack\n\n")
+        out.write('.segment "RODATA"\n\n')
+        out.write("_chr_pack:\n")
+        for i in range(0, len(packed), 16):
+            out.write("    .byte %s\n" % ",".join("$%02X" % v for v in packed[i:i + 16]))
+
+
+if __name__ == "__main__":
+    main()
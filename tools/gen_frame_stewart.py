@@ -0,0 +1,68 @@
+#!/usr/bin/env python3
+"""Generate par (optimal move count) tables for 3 and 4 pegs.
+
+3 pegs: 2^n - 1. 4 pegs (Reve's puzzle): Frame-Stewart,
+    FS(n) = min over k of 2*FS(k) + 2^(n-k) - 1
+together with the split point k that reaches the minimum, which the on-ROM
+solver (src/solver.c) uses to generate the optimal move sequence.
+
+Writes a ca65 source file (RODATA) and a C header.
+"""
+
+import argparse
+
+MAX_BLOCKS = 8     # keep in sync with src/hanoi.h
+MIN_TOWERS = 3
+MAX_TOWERS = 4
+
+
+def frame_stewart(max_n):
+    moves = [0] * (max_n + 1)
+    split = [0] * (max_n + 1)
+    for n in range(1, max_n + 1):
+        best = None
+        for k in range(0, n):
+            cost = 2 * moves[k] + (1 << (n - k)) - 1
+            if best is None or cost < best:
+                best, split[n] = cost, k
+        moves[n] = best
+    return moves, split
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--asm", required=True, help="ca65 output file")
+    parser.add_argument("--header", required=True, help="C header output file")
+    args = parser.parse_args()
+
+    three = [(1 << n) - 1 for n in range(MAX_BLOCKS + 1)]
+    four, split = frame_stewart(MAX_BLOCKS)
+    for row in (three, four):
+        assert all(v <= 255 for v in row), "par must fit game_state_t.min_moves"
+
+    with open(args.asm, "w") as out:
+        out.write("; Generated by tools/gen_frame_stewart.py - do not edit\n\n")
+        out.write(".export _par_moves, _fs_split\n\n")
+        out.write('.segment "RODATA"\n\n')
+        out.write("; par_moves[towers - 3][blocks]\n")
+        out.write("_par_moves:\n")
+        out.write("    .byte %s  ; 3 pegs\n" % ",".join(str(v) for v in three))
+        out.write("    .byte %s  ; 4 pegs (Frame-Stewart)\n" % ",".join(str(v) for v in four))
+        out.write("\n; fs_split[blocks]: top disks parked on a spare peg (4 pegs)\n")
+        out.write("_fs_split:\n")
+        out.write("    .byte %s\n" % ",".join(str(v) for v in split))
+
+    with open(args.header, "w") as out:
+        out.write("/* Generated by tools/gen_frame_stewart.py - do not edit */\n")
+        out.write("#ifndef FRAME_STEWART_H\n#define FRAME_STEWART_H\n\n")
+        out.write("/* Optimal move count by peg count (3-%d) and disk count (0-%d) */\n"
+                  % (MAX_TOWERS, MAX_BLOCKS))
+        out.write("extern const unsigned char par_moves[%d][%d];\n\n"
+                  % (MAX_TOWERS - MIN_TOWERS + 1, MAX_BLOCKS + 1))
+        out.write("/* 4 pegs: how many top disks the optimal solution parks first */\n")
+        out.write("extern const unsigned char fs_split[%d];\n\n" % (MAX_BLOCKS + 1))
+        out.write("#endif /* FRAME_STEWART_H */\n")
+
+
+if __name__ == "__main__":
+    main()
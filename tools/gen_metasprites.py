@@ -0,0 +1,109 @@
+#!/usr/bin/env python3
+"""Generate metasprite and tower layout tables.
+
+Metasprites: one per disk size plus the cursor, each a count followed by
+(dx, dy, tile, attr) entries. dx is relative to the metasprite's center
+and dy already includes the NES OAM "Y - 1", so src/metasprite.c places a
+sprite with two 8-bit adds. New disk art or sizes are a change here.
+
+Layouts: for each peg count, the pole tile columns, their pixel centers
+in playfield coordinates and the playfield width in tiles.
+
+Writes a ca65 source file (RODATA) and a C header.
+"""
+
+import argparse
+
+MAX_BLOCKS = 8     # keep in sync with src/hanoi.h
+MIN_TOWERS = 3
+MAX_TOWERS = 4
+
+# Disk look by size: (tile, sprite palette). Palette entry 1/2/3 comes from
+# the tile's pixel value, so three sizes share each palette.
+DISK_STYLE = {
+    1: (0x08, 0), 2: (0x09, 0), 3: (0x01, 0),
+    4: (0x08, 1), 5: (0x09, 1), 6: (0x01, 1),
+    7: (0x08, 2), 8: (0x09, 2),
+}
+CURSOR_TILE = 0x21
+
+# Pole columns by peg count; poles are 9 tiles apart so the widest disks
+# never touch. Layouts wider than 32 tiles scroll (see src/split.s).
+LAYOUTS = {
+    3: {"poles": [5, 14, 23], "width": 32},
+    4: {"poles": [5, 14, 23, 32], "width": 38},
+}
+
+
+def disk(size):
+    tile, palette = DISK_STYLE[size]
+    return [(-size * 4 + col * 8, -1, tile, palette) for col in range(size)]
+
+
+def metasprites():
+    sprites = [("disk %d" % size, disk(size)) for size in range(1, MAX_BLOCKS + 1)]
+    sprites.append(("cursor", [(-4, -1, CURSOR_TILE, 0)]))
+    return sprites
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--asm", required=True, help="ca65 output file")
+    parser.add_argument("--header", required=True, help="C header output file")
+    args = parser.parse_args()
+
+    sprites = metasprites()
+    offsets = []
+    size = 0
+    for _, entries in sprites:
+        offsets.append(size)
+        size += 1 + 4 * len(entries)
+    assert size <= 256, "metasprite offsets are 8-bit"
+
+    num_layouts = MAX_TOWERS - MIN_TOWERS + 1
+    with open(args.asm, "w") as out:
+        out.write("; Generated by tools/gen_metasprites.py - do not edit\n\n")
+        out.write(".export _metasprite_offset, _metasprite_data\n")
+        out.write(".export _layout_tile_x, _layout_center_px, _layout_width_tiles\n\n")
+        out.write('.segment "RODATA"\n\n')
+        out.write("_metasprite_offset:\n")
+        out.write("    .byte %s\n\n" % ",".join(str(o) for o in offsets))
+        out.write("; count, then dx, dy, tile, attr per sprite\n")
+        out.write("_metasprite_data:\n")
+        for name, entries in sprites:
+            out.write("    .byte %d  ; %s\n" % (len(entries), name))
+            for dx, dy, tile, attr in entries:
+                out.write("    .byte $%02X,$%02X,$%02X,$%02X\n"
+                          % (dx & 0xFF, dy & 0xFF, tile, attr))
+
+        out.write("\n; Layouts by peg count (%d-%d), unused towers 0\n" % (MIN_TOWERS, MAX_TOWERS))
+        out.write("_layout_tile_x:\n")
+        for pegs in range(MIN_TOWERS, MAX_TOWERS + 1):
+            poles = LAYOUTS[pegs]["poles"] + [0] * (MAX_TOWERS - pegs)
+            out.write("    .byte %s\n" % ",".join(str(p) for p in poles))
+        out.write("_layout_center_px:\n")
+        for pegs in range(MIN_TOWERS, MAX_TOWERS + 1):
+            centers = [p * 8 + 4 for p in LAYOUTS[pegs]["poles"]] + [0] * (MAX_TOWERS - pegs)
+            out.write("    .word %s\n" % ",".join(str(c) for c in centers))
+        out.write("_layout_width_tiles:\n")
+        out.write("    .byte %s\n" % ",".join(
+            str(LAYOUTS[pegs]["width"]) for pegs in range(MIN_TOWERS, MAX_TOWERS + 1)))
+
+    with open(args.header, "w") as out:
+        out.write("/* Generated by tools/gen_metasprites.py - do not edit */\n")
+        out.write("#ifndef METASPRITE_DATA_H\n#define METASPRITE_DATA_H\n\n")
+        out.write("/* Metasprite ids: disks by size (1-%d), then the cursor */\n" % MAX_BLOCKS)
+        out.write("#define METASPRITE_DISK(size) ((size) - 1)\n")
+        out.write("#define METASPRITE_CURSOR %d\n" % MAX_BLOCKS)
+        out.write("#define METASPRITE_COUNT %d\n\n" % len(sprites))
+        out.write("extern const unsigned char metasprite_offset[METASPRITE_COUNT];\n")
+        out.write("extern const unsigned char metasprite_data[];\n\n")
+        out.write("/* Tower layouts by peg count - %d */\n" % MIN_TOWERS)
+        out.write("extern const unsigned char layout_tile_x[%d][%d];\n" % (num_layouts, MAX_TOWERS))
+        out.write("extern const unsigned int layout_center_px[%d][%d];\n" % (num_layouts, MAX_TOWERS))
+        out.write("extern const unsigned char layout_width_tiles[%d];\n\n" % num_layouts)
+        out.write("#endif /* METASPRITE_DATA_H */\n")
+
+
+if __name__ == "__main__":
+    main()
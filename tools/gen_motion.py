@@ -0,0 +1,83 @@
+#!/usr/bin/env python3
+"""Generate the disk motion tables used by src/anim.c.
+
+Each table holds per-frame 8.8 fixed-point velocities for one distance, so
+the ROM only ever adds a table entry to a position; no runtime multiply.
+Positions sum exactly to the distance, so a finished move lands on the pixel.
+
+Writes a ca65 source file (RODATA) and a C header with the table sizes.
+"""
+
+import argparse
+
+# Playfield geometry; keep in sync with src/hanoi.h and src/hanoi.c
+MAX_TOWERS = 4
+MAX_BLOCKS = 8
+TOWER_SPACING_PX = 9 * 8   # layout_tile_x steps in hanoi.c
+HOLD_Y = 9 * 8             # HOLD_Y in hanoi.h
+BASE_ROW = 20              # BASE_ROW in hanoi.h
+
+LIFT_FRAMES = 8
+SLIDE_FRAMES = 10
+
+
+def ease_out(t):
+    return 1.0 - (1.0 - t) * (1.0 - t)
+
+
+def ease_in_out(t):
+    return t * t * (3.0 - 2.0 * t)
+
+
+def velocities(distance_px, frames, ease):
+    total = distance_px * 256
+    pos = [int(round(total * ease(i / frames))) for i in range(frames + 1)]
+    pos[0] = 0
+    pos[-1] = total
+    vel = [pos[i + 1] - pos[i] for i in range(frames)]
+    assert sum(vel) == total and all(0 <= v <= 0xFFFF for v in vel)
+    return vel
+
+
+def block_y(height):
+    return (BASE_ROW - 1 - height) * 8
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--asm", required=True, help="ca65 output file")
+    parser.add_argument("--header", required=True, help="C header output file")
+    args = parser.parse_args()
+
+    lift = [velocities(block_y(h) - HOLD_Y, LIFT_FRAMES, ease_out)
+            for h in range(MAX_BLOCKS)]
+    slide = [velocities(TOWER_SPACING_PX * d, SLIDE_FRAMES, ease_in_out)
+             for d in range(1, MAX_TOWERS)]
+
+    with open(args.asm, "w") as out:
+        out.write("; Generated by tools/gen_motion.py - do not edit\n\n")
+        out.write(".export _anim_lift_vy, _anim_slide_vx\n\n")
+        out.write('.segment "RODATA"\n\n')
+        out.write("; Lift from stack slot h to HOLD_Y, ease-out (drop runs it backwards)\n")
+        out.write("_anim_lift_vy:\n")
+        for h, row in enumerate(lift):
+            out.write("    .word %s  ; h=%d, %d px\n" % (
+                ",".join("$%04X" % v for v in row), h, block_y(h) - HOLD_Y))
+        out.write("\n; Slide by d towers, ease-in-out\n")
+        out.write("_anim_slide_vx:\n")
+        for d, row in enumerate(slide, 1):
+            out.write("    .word %s  ; d=%d\n" % (",".join("$%04X" % v for v in row), d))
+
+    with open(args.header, "w") as out:
+        out.write("/* Generated by tools/gen_motion.py - do not edit */\n")
+        out.write("#ifndef MOTION_H\n#define MOTION_H\n\n")
+        out.write("#define ANIM_LIFT_FRAMES %d\n" % LIFT_FRAMES)
+        out.write("#define ANIM_SLIDE_FRAMES %d\n\n" % SLIDE_FRAMES)
+        out.write("/* Per-frame 8.8 velocities */\n")
+        out.write("extern const unsigned int anim_lift_vy[%d][ANIM_LIFT_FRAMES];\n" % MAX_BLOCKS)
+        out.write("extern const unsigned int anim_slide_vx[%d][ANIM_SLIDE_FRAMES];\n\n" % (MAX_TOWERS - 1))
+        out.write("#endif /* MOTION_H */\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,101 @@
+#!/usr/bin/env python3
+"""Generate the on-screen text as tile strings.
+
+Each string becomes a length byte followed by its tile indices, so
+src/text.c draws or queues it with a plain copy. The tile mapping follows
+the CHR font in src/chr_rom.s: '0'-'9' at $10, 'A'-'Z' at $41, 'a'-'z' at
+$61, '!' and ':' at their ASCII codes, space is the blank tile $00. New or
+changed text is a change here.
+
+Writes a ca65 source file (RODATA) and a C header.
+"""
+
+import argparse
+
+# C name, text
+STRINGS = [
+    # Gameplay HUD labels
+    ("level", "LEVEL"),
+    ("lives", "LIVES"),
+    ("moves", "MOVES"),
+    ("time", "TIME"),
+    # Title
+    ("press_start", "PRESS START"),
+    ("pegs", " PEGS"),
+    ("race", " RACE "),
+    ("practice", "PRACTICE"),
+    ("practice_blank", "        "),
+    # Level clear overlay
+    ("nice", "NICE!"),
+    ("best", "BEST!"),
+    # Transition screens
+    ("life_lost", "LIFE LOST"),
+    ("too_many_moves", "TOO MANY MOVES"),
+    ("game_over", "GAME OVER"),
+    ("you_win", "YOU WIN"),
+    ("all_levels_complete", "ALL LEVELS COMPLETE"),
+    ("timed_from_resume", "TIMED FROM RESUME"),
+    # Race mode; the blank after "P" is the player digit
+    ("race_title", "RACE"),
+    ("race_hud", "P  L"),
+    ("race_wins", "P  WINS!"),
+    # Self-benchmark results (make selfbench)
+    ("selfbench", "SELFBENCH"),
+    ("frames", "FRAMES"),
+    ("lag_frames", "LAG FRAMES"),
+    ("worst_lines", "WORST LINES"),
+    ("peak_per_frame", "PEAK PER FRAME"),
+]
+
+MAX_LEN = 32   # one nametable row; also the VRAM queue's run limit
+
+
+def tile(c):
+    if "0" <= c <= "9":
+        return 0x10 + ord(c) - ord("0")
+    if "A" <= c <= "Z":
+        return 0x41 + ord(c) - ord("A")
+    if "a" <= c <= "z":
+        return 0x61 + ord(c) - ord("a")
+    if c == " ":
+        return 0x00
+    if c in "!:":
+        return ord(c)
+    raise ValueError("no tile for %r" % c)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--asm", required=True, help="ca65 output file")
+    parser.add_argument("--header", required=True, help="C header output file")
+    args = parser.parse_args()
+
+    names = set()
+    for name, text in STRINGS:
+        assert name not in names, "duplicate string name %s" % name
+        assert 0 < len(text) <= MAX_LEN, "%s is not 1-%d tiles" % (name, MAX_LEN)
+        names.add(name)
+
+    with open(args.asm, "w") as out:
+        out.write("; Generated by tools/gen_strings.py - do not edit\n\n")
+        out.write(".export %s\n\n" % ", ".join("_str_" + name for name, _ in STRINGS))
+        out.write('.segment "RODATA"\n\n')
+        out.write("; Length byte, then tiles\n")
+        for name, text in STRINGS:
+            out.write("_str_%s:  ; \"%s\"\n" % (name, text))
+            out.write("    .byte %d,%s\n" % (len(text), ",".join("$%02X" % tile(c) for c in text)))
+
+    with open(args.header, "w") as out:
+        out.write("/* Generated by tools/gen_strings.py - do not edit */\n")
+        out.write("#ifndef STRINGS_H\n#define STRINGS_H\n\n")
+        out.write("/* Tile strings: a length byte, then the tile indices */\n")
+        for name, text in STRINGS:
+            out.write("extern const unsigned char str_%s[];  /* \"%s\" */\n" % (name, text))
+        out.write("\n/* Lengths in tiles */\n")
+        for name, text in STRINGS:
+            out.write("#define STR_%s_LEN %d\n" % (name.upper(), len(text)))
+        out.write("\n#endif /* STRINGS_H */\n")
+
+
+if __name__ == "__main__":
+    main()
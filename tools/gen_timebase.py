@@ -0,0 +1,96 @@
+#!/usr/bin/env python3
+"""Generate per-region APU period tables and tempo steps.
+
+The pulse timer period for a note is CPU_CLOCK / (16 * f) - 1, so the same
+note needs a different period on each console: NTSC (1.789773 MHz),
+PAL (1.662607 MHz) and Dendy (1.773448 MHz, PAL frame rate). Notes are
+equal-tempered and, like the songs always have been, sound 15 semitones
+below their written name (NOTE_C4 plays the A at 110 Hz).
+
+Song and timer durations are written in NTSC frames. On 50 Hz consoles a
+frame covers NTSC_FPS / fps of those ticks; the fractional part, in 1/256
+units, is the per-frame step of the tempo accumulator in src/region.c.
+
+Writes a ca65 source file (RODATA) and a C header.
+"""
+
+import argparse
+
+REGIONS = [
+    # name, CPU clock (Hz), frame rate (Hz)
+    ("NTSC", 236250000 / 11 / 12, 236250000 / 11 / 12 / 29780.5),
+    ("PAL", 26601712.5 / 16, 26601712.5 / 16 / 33247.5),
+    ("DENDY", 26601712.5 / 15, 26601712.5 / 15 / 35464),
+]
+
+NATURALS = [("C", 0), ("D", 2), ("E", 4), ("F", 5), ("G", 7), ("A", 9), ("B", 11)]
+OCTAVES = range(3, 7)
+TRANSPOSE = -15       # Semitones between the written and the sounding pitch
+
+
+def note_list():
+    notes = []
+    for octave in OCTAVES:
+        for name, semitone in NATURALS:
+            midi = 12 * (octave + 1) + semitone + TRANSPOSE
+            notes.append(("%s%d" % (name, octave), 440.0 * 2 ** ((midi - 69) / 12.0)))
+    return notes
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--asm", required=True, help="ca65 output file")
+    parser.add_argument("--header", required=True, help="C header output file")
+    args = parser.parse_args()
+
+    notes = note_list()
+    assert len(notes) + 1 <= 32, "note index must fit MUSIC_NOTE's 5 bits"
+    ntsc_fps = REGIONS[0][2]
+
+    periods = []
+    steps = []
+    for name, clock, fps in REGIONS:
+        row = [0]  # NOTE_REST
+        for _, freq in notes:
+            period = int(round(clock / (16.0 * freq) - 1))
+            assert 8 <= period <= 0x7FF, "period out of pulse timer range"
+            row.append(period)
+        periods.append(row)
+        ratio = ntsc_fps / fps
+        assert 1.0 <= ratio < 2.0, "at most one extra tick per frame"
+        steps.append(int(round((ratio - 1.0) * 256)) & 0xFF)
+
+    with open(args.asm, "w") as out:
+        out.write("; Generated by tools/gen_timebase.py - do not edit\n\n")
+        out.write(".export _period_lo, _period_hi, _tempo_step\n\n")
+        out.write('.segment "RODATA"\n\n')
+        out.write("; period_lo/hi[region][note], note 0 = rest\n")
+        for label, shift in (("_period_lo", 0), ("_period_hi", 8)):
+            out.write("%s:\n" % label)
+            for (name, _, _), row in zip(REGIONS, periods):
+                out.write("    .byte %s  ; %s\n"
+                          % (",".join("$%02X" % ((p >> shift) & 0xFF) for p in row), name))
+        out.write("\n; tempo_step[region]: extra NTSC ticks per frame, 1/256 units\n")
+        out.write("_tempo_step:\n")
+        out.write("    .byte %s\n" % ",".join(str(s) for s in steps))
+
+    with open(args.header, "w") as out:
+        out.write("/* Generated by tools/gen_timebase.py - do not edit */\n")
+        out.write("#ifndef TIMEBASE_H\n#define TIMEBASE_H\n\n")
+        out.write("/* Note indices into the period tables */\n")
+        out.write("#define NOTE_REST 0\n")
+        for i, (name, _) in enumerate(notes):
+            out.write("#define NOTE_%s %d\n" % (name, i + 1))
+        out.write("#define NOTE_COUNT %d\n\n" % (len(notes) + 1))
+        out.write("/* Pulse timer period by region and note */\n")
+        out.write("extern const unsigned char period_lo[%d][%d];\n"
+                  % (len(REGIONS), len(notes) + 1))
+        out.write("extern const unsigned char period_hi[%d][%d];\n\n"
+                  % (len(REGIONS), len(notes) + 1))
+        out.write("/* Tempo accumulator step by region */\n")
+        out.write("extern const unsigned char tempo_step[%d];\n\n" % len(REGIONS))
+        out.write("#endif /* TIMEBASE_H */\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,112 @@
+-- Power-on to title.
+--
+-- Counts frames from power-on to the first frame that ends with the title
+-- fully drawn (every nametable byte as expected, pink backdrop, background
+-- rendering on) and the title song started (first pulse 1 timer write). Fails if that takes longer than
+-- BUDGET frames: the startup code's two-vblank warm-up, one frame for the
+-- region measurement and one for the title stream, plus slack.
+
+local BUDGET = 6
+local GIVE_UP = 60
+
+local COLOR_PINK = 0x14
+
+-- The finished title, built the way draw_title_screen() streams it: the
+-- big words from the 5x5 font in src/main.c (solid tile $08), "3 PEGS"
+-- and "PRESS START" as font tiles, everything else blank, attributes 0.
+-- Every byte of nametable $2000 is checked, so a stream that an NMI or a
+-- stray write knocked to another address fails.
+local BIG_FONT = {
+  A = { ".###.", "#...#", "#####", "#...#", "#...#" },
+  E = { "#####", "#....", "####.", "#....", "#####" },
+  F = { "#####", "#....", "####.", "#....", "#...." },
+  H = { "#...#", "#...#", "#####", "#...#", "#...#" },
+  I = { "#####", "..#..", "..#..", "..#..", "#####" },
+  N = { "#...#", "##..#", "#.#.#", "#..##", "#...#" },
+  O = { ".###.", "#...#", "#...#", "#...#", ".###." },
+  R = { "####.", "#...#", "####.", "#.#..", "#..#." },
+  T = { "#####", "..#..", "..#..", "..#..", "..#.." },
+  W = { "#...#", "#...#", "#.#.#", "##.##", "#...#" },
+}
+local WORDS = { { 4, "TOWER" }, { 11, "OF" }, { 18, "HANOI" } }
+local TEXT = { { 24, 13, "3 PEGS" }, { 26, 10, "PRESS START" } }
+
+local function text_tile(c)
+  if c == " " then return 0x00 end
+  if c:match("%d") then return 0x10 + tonumber(c) end
+  return c:byte()                        -- 'A'-'Z' sit at their ASCII codes
+end
+
+local expected = {}
+for i = 0, 1023 do
+  expected[i] = 0x00
+end
+for _, word in ipairs(WORDS) do
+  local x = (32 - (#word[2] * 6 - 1)) // 2
+  for g = 1, #word[2] do
+    local glyph = BIG_FONT[word[2]:sub(g, g)]
+    for row = 1, 5 do
+      for c = 1, 5 do
+        if glyph[row]:sub(c, c) == "#" then
+          expected[(word[1] + row - 1) * 32 + x + c - 1] = 0x08
+        end
+      end
+    end
+    x = x + 6
+  end
+end
+for _, text in ipairs(TEXT) do
+  for i = 1, #text[3] do
+    expected[text[1] * 32 + text[2] + i - 1] = text_tile(text[3]:sub(i, i))
+  end
+end
+
+local mask = 0
+local song_frame = nil
+
+emu.addMemoryCallback(function(address, value)
+  mask = value
+end, emu.callbackType.write, 0x2001)
+
+emu.addMemoryCallback(function()
+  if not song_frame then
+    song_frame = harness.frame
+  end
+end, emu.callbackType.write, 0x4002, 0x4003)
+
+local function title_drawn()
+  if (mask & 0x08) == 0 then
+    return false
+  end
+  if emu.read(0, emu.memType.nesPaletteRam) ~= COLOR_PINK then
+    return false
+  end
+  for i = 0, 1023 do
+    if emu.read(i, emu.memType.nesNametableRam) ~= expected[i] then
+      return false
+    end
+  end
+  return true
+end
+
+harness.on_frame(function()
+  if song_frame and title_drawn() then
+    harness.log("frames to title: %d (budget %d)", harness.frame, BUDGET)
+    if harness.frame > BUDGET then
+      harness.fail("title took %d frames, over budget by %d", harness.frame,
+        harness.frame - BUDGET)
+    end
+    harness.finish()
+  elseif harness.frame >= GIVE_UP then
+    harness.fail("no complete title with music after %d frames", GIVE_UP)
+    for i = 0, 1023 do
+      local tile = emu.read(i, emu.memType.nesNametableRam)
+      if tile ~= expected[i] then
+        harness.log("first wrong tile: row %d col %d is $%02X, expected $%02X",
+          i // 32, i % 32, tile, expected[i])
+        break
+      end
+    end
+    harness.finish()
+  end
+end)
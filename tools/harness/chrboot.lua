@@ -0,0 +1,66 @@
+-- CHR-RAM boot cost (make chrram).
+--
+-- Times chr_unpack from its entry to its return (found through the ld65
+-- labels) and checks the unpacked tiles. The unpack runs once, in init_nes,
+-- after the startup code's two-vblank warm-up, with rendering off; it must
+-- fit in one frame on top of that so the title still appears on time.
+
+local BUDGET = 29780        -- CPU cycles: one NTSC frame
+local CHECK_FRAME = 60
+
+local unpack = harness_symbols and harness_symbols["chr_unpack"]
+local done = harness_symbols and harness_symbols["chr_unpack_done"]
+if not unpack or not done then
+  harness.fail("chr_unpack/chr_unpack_done missing from the ld65 labels")
+  harness.finish()
+end
+
+local started = nil
+local cycles = nil
+
+emu.addMemoryCallback(function()
+  started = harness.cpu_cycles()
+end, emu.callbackType.exec, unpack)
+
+emu.addMemoryCallback(function()
+  if started and not cycles then
+    cycles = harness.cpu_cycles() - started
+  end
+end, emu.callbackType.exec, done)
+
+-- Spot checks: tile $01 is solid color 3 (packed as a plane copy), tile $08
+-- solid color 1 (plane 0 only)
+local function tile_bytes(tile)
+  local bytes = {}
+  for i = 0, 15 do
+    bytes[#bytes + 1] = emu.read(tile * 16 + i, emu.memType.nesChrRam)
+  end
+  return bytes
+end
+
+harness.on_frame(function()
+  if harness.frame < CHECK_FRAME then
+    return
+  end
+
+  if not cycles then
+    harness.fail("chr_unpack never returned")
+  else
+    harness.log("chr_unpack: %d cycles (budget %d)", cycles, BUDGET)
+    if cycles > BUDGET then
+      harness.fail("chr_unpack took %d cycles, over budget by %d", cycles, cycles - BUDGET)
+    end
+  end
+
+  local solid, lo_only = tile_bytes(0x01), tile_bytes(0x08)
+  for i = 1, 16 do
+    if solid[i] ~= 0xFF then
+      harness.fail("tile $01 byte %d is $%02X, want $FF", i - 1, solid[i])
+    end
+    local want = (i <= 8) and 0xFF or 0x00
+    if lo_only[i] ~= want then
+      harness.fail("tile $08 byte %d is $%02X, want $%02X", i - 1, lo_only[i], want)
+    end
+  end
+  harness.finish()
+end)
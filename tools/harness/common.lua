@@ -0,0 +1,187 @@
+-- Shared helpers for the headless harness.
+--
+-- The harness runs under Mesen 2's test runner:
+--   Mesen --testrunner build/hanoi.nes build/harness-<mode>.lua
+-- `make harness-<mode>` concatenates this file with tools/harness/<mode>.lua
+-- and runs it. Modes report with emu.log() and exit non-zero on failure.
+-- The ROM's ld65 labels are prepended as harness_symbols[name] (C names
+-- without the leading underscore).
+
+harness = {}
+
+-- Number of completed frames (incremented at every endFrame event)
+harness.frame = 0
+
+-- Frame-indexed controller input: inputs[n] is applied to the first pad
+-- poll after n frames have completed.
+local inputs = {}
+local frame_handlers = {}
+local poll_handlers = {}
+local failures = 0
+
+function harness.log(fmt, ...)
+  emu.log(string.format(fmt, ...))
+end
+
+function harness.fail(fmt, ...)
+  failures = failures + 1
+  emu.log("FAIL: " .. string.format(fmt, ...))
+end
+
+-- Hold `buttons` (e.g. {a=true}) for the pad poll of the given frame
+function harness.press(frame, buttons)
+  inputs[frame] = buttons
+end
+
+function harness.on_frame(fn)
+  table.insert(frame_handlers, fn)
+end
+
+function harness.on_poll(fn)
+  table.insert(poll_handlers, fn)
+end
+
+-- Finish the run: exit code 0 when nothing failed
+function harness.finish()
+  if failures > 0 then
+    harness.log("%d failure(s)", failures)
+    emu.stop(1)
+  else
+    harness.log("OK")
+    emu.stop(0)
+  end
+end
+
+-- Schedule presses that solve levels 1..last_level with 3 pegs, optimally,
+-- starting at `frame` on a fresh game (cursor on tower 0). Each press is one
+-- pad poll, `spacing` frames apart; a level clear is skipped with A. Returns
+-- the first free frame after the last level's final move.
+function harness.play_levels(frame, last_level, spacing)
+  local moves = {}
+  local function solve(n, from, to, via)
+    if n == 0 then return end
+    solve(n - 1, from, via, to)
+    table.insert(moves, { from, to })
+    solve(n - 1, via, to, from)
+  end
+
+  for level = 1, last_level do
+    local cursor = 0
+    local function go(tower)
+      while cursor ~= tower do
+        harness.press(frame, (tower > cursor) and { right = true } or { left = true })
+        cursor = cursor + ((tower > cursor) and 1 or -1)
+        frame = frame + spacing
+      end
+    end
+
+    moves = {}
+    solve(level, 0, 2, 1)
+    for _, m in ipairs(moves) do
+      go(m[1])
+      harness.press(frame, { a = true })
+      frame = frame + spacing
+      go(m[2])
+      harness.press(frame, { a = true })
+      frame = frame + spacing
+    end
+
+    if level < last_level then
+      harness.press(frame + 20, { a = true })   -- skip "NICE!"
+      frame = frame + 40                        -- next level is drawn
+    end
+  end
+  return frame
+end
+
+-- What input can change on screen: OAM plus both nametables, minus the
+-- speedrun clock (HUD row 3 from column 19: tiles, or sprites in SPRITE_HUD
+-- builds), which changes every frame on its own. OAM entries are sorted, so
+-- the slot rotation of crowded stacks does not count as a change.
+local CLOCK_ROW, CLOCK_COL, CLOCK_LEN = 3, 19, 8
+function harness.snapshot()
+  local sprites = {}
+  for i = 0, 63 do
+    local y = emu.read(i * 4, emu.memType.nesSpriteRam)
+    local x = emu.read(i * 4 + 3, emu.memType.nesSpriteRam)
+    if not (y == CLOCK_ROW * 8 - 1 and x >= CLOCK_COL * 8) then
+      sprites[#sprites + 1] = string.char(y, emu.read(i * 4 + 1, emu.memType.nesSpriteRam),
+        emu.read(i * 4 + 2, emu.memType.nesSpriteRam), x)
+    end
+  end
+  table.sort(sprites)
+
+  local bytes = {}
+  local clock = CLOCK_ROW * 32 + CLOCK_COL
+  for i = 0, 2047 do
+    if i < clock or i >= clock + CLOCK_LEN then
+      bytes[#bytes + 1] = string.char(emu.read(i, emu.memType.nesNametableRam))
+    end
+  end
+  return table.concat(sprites) .. table.concat(bytes)
+end
+
+-- Current PPU position as scanline, dot
+function harness.ppu_position()
+  local state = emu.getState()
+  if state["ppu.scanline"] ~= nil then
+    return state["ppu.scanline"], state["ppu.cycle"]
+  end
+  return state.ppu.scanline, state.ppu.cycle
+end
+
+-- CPU cycles since power-on
+function harness.cpu_cycles()
+  local state = emu.getState()
+  if state["cpu.cycleCount"] ~= nil then
+    return state["cpu.cycleCount"]
+  end
+  return state.cpu.cycleCount
+end
+
+-- Address of the instruction being executed
+function harness.cpu_pc()
+  local state = emu.getState()
+  if state["cpu.pc"] ~= nil then
+    return state["cpu.pc"]
+  end
+  return state.cpu.pc
+end
+
+-- ld65 label at or below a CPU address, as "name+offset" (for reports)
+local sorted_symbols = nil
+function harness.symbol_at(addr)
+  if not sorted_symbols then
+    sorted_symbols = {}
+    for name, a in pairs(harness_symbols or {}) do
+      table.insert(sorted_symbols, { a, name })
+    end
+    table.sort(sorted_symbols, function(x, y) return x[1] < y[1] end)
+  end
+  local best = nil
+  for _, entry in ipairs(sorted_symbols) do
+    if entry[1] > addr then break end
+    if entry[1] >= 0x8000 then best = entry end
+  end
+  if not best then
+    return string.format("$%04X", addr)
+  end
+  return string.format("%s+%d", best[2], addr - best[1])
+end
+
+emu.addEventCallback(function()
+  local buttons = inputs[harness.frame]
+  if buttons then
+    emu.setInput(buttons, 0)
+  end
+  for _, fn in ipairs(poll_handlers) do
+    fn(buttons)
+  end
+end, emu.eventType.inputPolled)
+
+emu.addEventCallback(function()
+  harness.frame = harness.frame + 1
+  for _, fn in ipairs(frame_handlers) do
+    fn()
+  end
+end, emu.eventType.endFrame)
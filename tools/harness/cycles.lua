@@ -0,0 +1,97 @@
+-- Main loop CPU cycles per frame.
+--
+-- A frame's work runs from the NMI at the start of vblank to the main loop's
+-- next call of wait_vblank (found through the ld65 labels). The sprite-0
+-- wait inside split_scroll is idle time and is left out: it runs from the
+-- split_scroll call to the split's last $2005 write.
+--
+-- "fixed" is the cheapest idle gameplay frame (no input, nothing moving),
+-- the overhead every frame pays. "avg" and "peak" cover a played session.
+-- The run logs one "CYCLES" line; `make harness-cycles` feeds the per-file
+-- build's line to the unity build as harness_baseline, which then reports
+-- the deltas and fails unless the fixed overhead went down.
+
+local IDLE_FIRST, IDLE_LAST = 90, 390   -- gameplay screen up, no input
+local PLAY_FROM = 400
+local SPACING = 8
+
+local wait_vblank = harness_symbols and harness_symbols["wait_vblank"]
+local split_scroll = harness_symbols and harness_symbols["split_scroll"]
+if not wait_vblank or not split_scroll then
+  harness.fail("wait_vblank/split_scroll missing from the ld65 labels")
+  harness.finish()
+end
+
+local nmi_at = nil          -- CPU cycle of this frame's NMI
+local split_at = nil        -- CPU cycle split_scroll was entered
+local split_end = nil       -- CPU cycle of its last $2005 write
+local busy = {}             -- busy cycles by frame
+
+emu.addEventCallback(function()
+  nmi_at = harness.cpu_cycles()
+  split_at, split_end = nil, nil
+end, emu.eventType.nmi)
+
+emu.addMemoryCallback(function()
+  split_at = harness.cpu_cycles()
+end, emu.callbackType.exec, split_scroll)
+
+emu.addMemoryCallback(function()
+  if split_at then
+    split_end = harness.cpu_cycles()
+  end
+end, emu.callbackType.write, 0x2005)
+
+emu.addMemoryCallback(function()
+  if not nmi_at then
+    return
+  end
+  local cycles = harness.cpu_cycles() - nmi_at
+  if split_at and split_end then
+    cycles = cycles - (split_end - split_at)
+  end
+  busy[harness.frame] = cycles
+  nmi_at = nil
+end, emu.callbackType.exec, wait_vblank)
+
+harness.press(30, { start = true })
+local play_end = harness.play_levels(PLAY_FROM, 3, SPACING)
+
+harness.on_frame(function()
+  if harness.frame < play_end + 30 then
+    return
+  end
+
+  local fixed, peak, total, count = nil, 0, 0, 0
+  for frame = IDLE_FIRST, IDLE_LAST do
+    local c = busy[frame]
+    if c and (not fixed or c < fixed) then fixed = c end
+  end
+  for frame = PLAY_FROM, play_end do
+    local c = busy[frame]
+    if c then
+      total = total + c
+      count = count + 1
+      if c > peak then peak = c end
+    end
+  end
+  if not fixed or count == 0 then
+    harness.fail("no main loop frames measured")
+    harness.finish()
+    return
+  end
+
+  local avg = math.floor(total / count)
+  harness.log("CYCLES fixed = %d, avg = %d, peak = %d", fixed, avg, peak)
+
+  if harness_baseline then
+    harness.log("delta vs per-file build: fixed %+d, avg %+d, peak %+d",
+      fixed - harness_baseline.fixed, avg - harness_baseline.avg,
+      peak - harness_baseline.peak)
+    if fixed >= harness_baseline.fixed then
+      harness.fail("fixed overhead %d did not drop below the per-file build's %d",
+        fixed, harness_baseline.fixed)
+    end
+  end
+  harness.finish()
+end)
@@ -0,0 +1,105 @@
+-- Input-to-display latency per action.
+--
+-- Each step presses one button for a single pad poll and counts frames until
+-- OAM or the nametables change. Latency is reported in displayed frames after
+-- the frame that read the pad: 1 means the change is visible in the very next
+-- frame, which is the floor for a game that reads input after vblank.
+--
+-- harness.snapshot() leaves out the running clock; the "idle" step first
+-- checks that frames with no input leave it unchanged, or every press
+-- would "change" the screen at once and the latencies would mean nothing.
+
+local LATENCY_BUDGET = 1   -- frames; any action above this fails the run
+local TIMEOUT = 10         -- frames without a visible change = failure
+local SETTLE = 10          -- idle frames between actions
+local IDLE_FRAMES = 30     -- frames the idle step watches
+
+local steps = {
+  { name = "start",       buttons = { start = true }, measure = false, settle = 60 },
+  { name = "idle",        idle = true },
+  { name = "cursor move", buttons = { right = true } },
+  { name = "cursor move", buttons = { left = true } },
+  { name = "pickup",      buttons = { a = true } },
+  { name = "cancel",      buttons = { b = true } },
+  { name = "pickup",      buttons = { a = true } },
+  { name = "cursor move", buttons = { right = true } },
+  { name = "place",       buttons = { a = true } },
+}
+
+local step = 0
+local next_at = 30          -- let the title screen come up
+local baseline = nil
+local polled_at = nil
+local worst = {}
+local idle_until = nil
+
+harness.on_poll(function(buttons)
+  if buttons and baseline and not polled_at then
+    polled_at = harness.frame
+  end
+end)
+
+harness.on_frame(function()
+  local s = steps[step]
+
+  if idle_until then
+    if harness.snapshot() ~= baseline then
+      harness.fail("screen changed with no input (frame %d); latencies would be meaningless",
+        harness.frame)
+      idle_until = harness.frame
+    end
+    if harness.frame >= idle_until then
+      idle_until = nil
+      baseline = nil
+      next_at = harness.frame + SETTLE
+    end
+    return
+  end
+
+  if baseline and polled_at then
+    local latency = harness.frame - polled_at - 1
+    if harness.snapshot() ~= baseline then
+      harness.log("%-12s %d frame(s)", s.name, latency)
+      if not worst[s.name] or latency > worst[s.name] then
+        worst[s.name] = latency
+      end
+      if latency > LATENCY_BUDGET then
+        harness.fail("%s latency %d exceeds budget %d", s.name, latency, LATENCY_BUDGET)
+      end
+      baseline = nil
+      next_at = harness.frame + SETTLE
+    elseif latency >= TIMEOUT then
+      harness.fail("%s: no visible change after %d frames", s.name, TIMEOUT)
+      baseline = nil
+      next_at = harness.frame + SETTLE
+    end
+    return
+  end
+
+  if harness.frame < next_at then
+    return
+  end
+
+  step = step + 1
+  s = steps[step]
+  if not s then
+    for name, frames in pairs(worst) do
+      harness.log("worst %-12s %d frame(s)", name, frames)
+    end
+    harness.finish()
+    return
+  end
+
+  polled_at = nil
+  if s.idle then
+    baseline = harness.snapshot()
+    idle_until = harness.frame + IDLE_FRAMES
+    return
+  end
+  harness.press(harness.frame, s.buttons)
+  if s.measure == false then
+    next_at = harness.frame + (s.settle or SETTLE)
+  else
+    baseline = harness.snapshot()
+  end
+end)
@@ -0,0 +1,218 @@
+-- Lockstep replay.
+--
+-- Plays a fixed input script from power-on: Start, three levels solved,
+-- then pseudo-random presses from a fixed seed until lockstep_frames. Every
+-- frame it hashes the 2KB of internal RAM and the 256 bytes of OAM twice:
+-- in address order (raw) and variable by variable in name order from the
+-- ld65 debug file (lockstep_symbols, tools/lockstep_symbols.py), which
+-- stays comparable across builds whose RAM layouts differ.
+--
+-- `make harness-lockstep` runs it three ways:
+--   record:  no reference; logs "LOCKSTEP <symbols> <raw>" each frame
+--   compare: lockstep_reference holds a recorded run; fails at the first
+--            frame whose hashes differ (raw only when the layouts match)
+--            and logs that frame's RAM and OAM
+--   locate:  lockstep_at is set; replays the reference to that frame and
+--            names the first differing variable and byte, and which of the
+--            KEY_SYMBOLS differ
+--
+-- Across builds, pointer variables hold build-specific addresses; list
+-- them in lockstep_ignore (LOCKSTEP_IGNORE) to leave them out of the
+-- variable hash.
+--
+-- Only integer adds, multiplies and masks per byte, so hour-long soaks
+-- (LOCKSTEP_FRAMES=216000) stay practical.
+
+local PLAY_FROM = 120
+local SPACING = 8
+local RANDOM_SPACING = 5
+local SEED = 0x2F6E2B1
+
+local RAM_SIZE = 0x800
+local OAM_SIZE = 256
+local KEY_SYMBOLS = { "hanoi_game", "game_state", "note_index" }
+local BUTTONS = { "a", "b", "select", "start", "up", "down", "left", "right" }
+
+local frames = lockstep_frames or 3600
+local state = {}              -- state[0..2047] RAM, state[2048..2303] OAM
+local symbols = {}
+for _, sym in ipairs(lockstep_symbols or {}) do
+  if not (lockstep_ignore or {})[sym[1]] then
+    table.insert(symbols, sym)
+  end
+end
+
+local function read_state()
+  local h = 0
+  for i = 0, RAM_SIZE - 1 do
+    local b = emu.read(i, emu.memType.nesInternalRam)
+    state[i] = b
+    h = (h * 31 + b) & 0xFFFFFFFF
+  end
+  for i = 0, OAM_SIZE - 1 do
+    local b = emu.read(i, emu.memType.nesSpriteRam)
+    state[RAM_SIZE + i] = b
+    h = (h * 31 + b) & 0xFFFFFFFF
+  end
+  return h
+end
+
+local function symbol_hash()
+  local h = 0
+  for _, sym in ipairs(symbols) do
+    for a = sym[2], sym[2] + sym[3] - 1 do
+      h = (h * 31 + state[a]) & 0xFFFFFFFF
+    end
+  end
+  for i = RAM_SIZE, RAM_SIZE + OAM_SIZE - 1 do
+    h = (h * 31 + state[i]) & 0xFFFFFFFF
+  end
+  return h
+end
+
+-- Names, addresses and sizes: equal layouts make raw hashes comparable
+local function layout_hash(list)
+  local h = 0
+  for _, sym in ipairs(list) do
+    for i = 1, #sym[1] do
+      h = (h * 31 + sym[1]:byte(i)) & 0xFFFFFFFF
+    end
+    h = (h * 31 + sym[2] * 256 + sym[3]) & 0xFFFFFFFF
+  end
+  return h
+end
+
+-- Input: the scripted levels, then one press every RANDOM_SPACING frames
+harness.press(30, { start = true })
+local frame = harness.play_levels(PLAY_FROM, 3, SPACING)
+local seed = SEED
+while frame < frames do
+  seed = (seed * 1103515245 + 12345) & 0x7FFFFFFF
+  harness.press(frame, { [BUTTONS[(seed >> 16) % #BUTTONS + 1]] = true })
+  frame = frame + RANDOM_SPACING
+end
+
+local by_name = {}
+for _, sym in ipairs(lockstep_symbols or {}) do
+  by_name[sym[1]] = sym
+end
+for _, name in ipairs(KEY_SYMBOLS) do
+  if not by_name[name] then
+    harness.fail("%s not in the debug file (objects assembled without -g?)", name)
+  end
+end
+
+local layout = layout_hash(lockstep_symbols or {})
+local same_layout = (lockstep_reference_layout == layout)
+
+local function hex_state()
+  local out = {}
+  for i = 0, RAM_SIZE + OAM_SIZE - 1 do
+    out[#out + 1] = string.format("%02X", state[i])
+  end
+  return table.concat(out)
+end
+
+-- Reference run at the divergent frame: compare with the other run's dump
+local function locate()
+  local other = {}
+  for i = 0, RAM_SIZE + OAM_SIZE - 1 do
+    other[i] = tonumber(lockstep_other_ram:sub(i * 2 + 1, i * 2 + 2), 16)
+  end
+  local other_by_name = {}
+  for _, sym in ipairs(lockstep_other_symbols or {}) do
+    other_by_name[sym[1]] = sym
+  end
+
+  local differs = {}
+  local first = nil
+  local missing = 0
+  for _, sym in ipairs(symbols) do
+    local o = other_by_name[sym[1]]
+    if not o then
+      missing = missing + 1
+    else
+      for i = 0, math.min(sym[3], o[3]) - 1 do
+        if state[sym[2] + i] ~= other[o[2] + i] then
+          differs[sym[1]] = true
+          if not first then
+            first = string.format("%s+%d ($%04X here, $%04X there): $%02X vs $%02X",
+              sym[1], i, sym[2] + i, o[2] + i, state[sym[2] + i], other[o[2] + i])
+          end
+          break
+        end
+      end
+    end
+  end
+  if missing > 0 then
+    harness.log("%d variable(s) only in the reference build", missing)
+  end
+
+  if first then
+    harness.fail("first divergent variable at frame %d: %s", lockstep_at, first)
+  end
+  for i = RAM_SIZE, RAM_SIZE + OAM_SIZE - 1 do
+    if state[i] ~= other[i] then
+      harness.fail("first divergent OAM byte at frame %d: %d: $%02X vs $%02X",
+        lockstep_at, i - RAM_SIZE, state[i], other[i])
+      break
+    end
+  end
+  if not first and same_layout then
+    for i = 0, RAM_SIZE - 1 do
+      if state[i] ~= other[i] then
+        harness.fail("first divergent RAM byte at frame %d: $%04X (no C variable): $%02X vs $%02X",
+          lockstep_at, i, state[i], other[i])
+        break
+      end
+    end
+  end
+  for _, name in ipairs(KEY_SYMBOLS) do
+    harness.log("%s: %s", name, differs[name] and "differs" or "same")
+  end
+end
+
+if lockstep_at then
+  same_layout = (layout_hash(lockstep_other_symbols or {}) == layout)
+end
+
+harness.on_frame(function()
+  local f = harness.frame
+  local raw = read_state()
+
+  if lockstep_at then
+    if f == lockstep_at then
+      locate()
+      harness.finish()
+    end
+    return
+  end
+
+  local sym = symbol_hash()
+  if not lockstep_reference then
+    if f == 1 then
+      harness.log("LOCKSTEP_LAYOUT 0x%08X", layout)
+    end
+    harness.log("LOCKSTEP 0x%08X 0x%08X", sym, raw)
+  else
+    local ref_sym = lockstep_reference[f * 2 - 1]
+    if ref_sym == nil then
+      harness.log("reference ends at frame %d", f - 1)
+      harness.finish()
+      return
+    end
+    if sym ~= ref_sym or (same_layout and raw ~= lockstep_reference[f * 2]) then
+      harness.log("LOCKSTEP_AT %d", f)
+      harness.log("LOCKSTEP_RAM %s", hex_state())
+      harness.fail("diverged from the reference at frame %d%s", f,
+        same_layout and "" or " (different RAM layouts: variables and OAM only)")
+      harness.finish()
+      return
+    end
+  end
+
+  if f >= frames then
+    harness.log(lockstep_reference and "%d frames in lockstep" or "%d frames recorded", frames)
+    harness.finish()
+  end
+end)
@@ -0,0 +1,164 @@
+-- PPU write audit.
+--
+-- Traps every PPU_MASK ($2001), PPU_ADDR ($2006), PPU_DATA ($2007) and OAM
+-- DMA ($4014) write from power-on through the title, a game start and three
+-- cleared levels with their transitions.
+--
+-- Unsafe (the run fails): PPU_ADDR, PPU_DATA or OAM DMA writes made while
+-- rendering is on and the PPU is outside vblank. Each distinct site (the
+-- nearest ld65 label) is listed with its first frame and scanline.
+--
+-- Reported, to drive towards zero:
+--   mid-frame PPU_MASK changes (rendering switched outside vblank),
+--   redundant PPU_DATA writes (the byte already at that VRAM address),
+--   redundant PPU_ADDR sets (the PPU already pointed there),
+--   VRAM bytes per frame (average over frames that wrote any, and peak).
+
+local PLAY_FROM = 120
+local SPACING = 8
+local SETTLE = 240            -- frames after the last move: NICE!, fade, redraw
+
+-- Vblank lines by region, told apart by CPU cycles per frame: NTSC
+-- 29781 (lines 241-260), PAL 33248 (241-310), Dendy 35464 (291-310).
+-- Anything else, including the pre-render line, is outside vblank.
+local REGIONS = {
+  { max_cycles = 31500, first = 241, last = 260 },    -- NTSC
+  { max_cycles = 34350, first = 241, last = 310 },    -- PAL
+  { max_cycles = math.huge, first = 291, last = 310 } -- Dendy
+}
+local vblank_first, vblank_last = 241, 260           -- NTSC until measured
+local last_frame_cycles = nil
+
+local ctrl = 0                -- last PPU_CTRL write (bit 2: +32 increment)
+local mask = 0                -- last PPU_MASK write
+local latch_high = nil        -- first half of a PPU_ADDR pair
+local vram_addr = nil         -- where the next PPU_DATA write lands
+local vram = {}               -- last byte written to each VRAM address
+
+local unsafe = {}             -- site -> { count, frame, scanline, what }
+local unsafe_order = {}
+local mask_mid_frame = {}     -- site -> count
+local redundant_data, redundant_addr, addr_sets, data_writes = 0, 0, 0, 0
+local frame_bytes = 0
+local byte_frames, byte_total, byte_peak, peak_frame = 0, 0, 0, 0
+
+local function in_vblank(scanline)
+  return scanline >= vblank_first and scanline <= vblank_last
+end
+
+local function rendering()
+  return (mask & 0x18) ~= 0
+end
+
+local function check_unsafe(what)
+  local scanline = harness.ppu_position()
+  if not rendering() or in_vblank(scanline) then
+    return
+  end
+  local site = harness.symbol_at(harness.cpu_pc())
+  local entry = unsafe[site]
+  if not entry then
+    entry = { count = 0, frame = harness.frame, scanline = scanline, what = what }
+    unsafe[site] = entry
+    table.insert(unsafe_order, site)
+  end
+  entry.count = entry.count + 1
+end
+
+emu.addMemoryCallback(function(address, value)
+  ctrl = value
+end, emu.callbackType.write, 0x2000)
+
+emu.addMemoryCallback(function(address, value)
+  local scanline = harness.ppu_position()
+  if ((mask ~ value) & 0x18) ~= 0 and not in_vblank(scanline) then
+    local site = harness.symbol_at(harness.cpu_pc())
+    mask_mid_frame[site] = (mask_mid_frame[site] or 0) + 1
+  end
+  mask = value
+end, emu.callbackType.write, 0x2001)
+
+-- Reading PPU_STATUS resets the PPU_ADDR/PPU_SCROLL write latch
+emu.addMemoryCallback(function()
+  latch_high = nil
+end, emu.callbackType.read, 0x2002)
+
+emu.addMemoryCallback(function()
+  latch_high = (latch_high == nil) and 0 or nil
+end, emu.callbackType.write, 0x2005)
+
+emu.addMemoryCallback(function(address, value)
+  check_unsafe("PPU_ADDR")
+  if latch_high == nil then
+    latch_high = value & 0x3F
+    return
+  end
+  local addr = (latch_high << 8) | value
+  latch_high = nil
+  addr_sets = addr_sets + 1
+  if addr == vram_addr then
+    redundant_addr = redundant_addr + 1
+  end
+  vram_addr = addr
+end, emu.callbackType.write, 0x2006)
+
+emu.addMemoryCallback(function(address, value)
+  check_unsafe("PPU_DATA")
+  data_writes = data_writes + 1
+  frame_bytes = frame_bytes + 1
+  if vram_addr ~= nil then
+    if vram[vram_addr] == value then
+      redundant_data = redundant_data + 1
+    end
+    vram[vram_addr] = value
+    vram_addr = (vram_addr + (((ctrl & 0x04) ~= 0) and 32 or 1)) & 0x3FFF
+  end
+end, emu.callbackType.write, 0x2007)
+
+emu.addMemoryCallback(function()
+  check_unsafe("OAM DMA")
+end, emu.callbackType.write, 0x4014)
+
+harness.press(30, { start = true })
+local play_end = harness.play_levels(PLAY_FROM, 3, SPACING)
+
+harness.on_frame(function()
+  local cycles = harness.cpu_cycles()
+  if last_frame_cycles then
+    for _, region in ipairs(REGIONS) do
+      if cycles - last_frame_cycles <= region.max_cycles then
+        vblank_first, vblank_last = region.first, region.last
+        break
+      end
+    end
+  end
+  last_frame_cycles = cycles
+
+  if frame_bytes > 0 then
+    byte_frames = byte_frames + 1
+    byte_total = byte_total + frame_bytes
+    if frame_bytes > byte_peak then
+      byte_peak, peak_frame = frame_bytes, harness.frame
+    end
+  end
+  frame_bytes = 0
+
+  if harness.frame < play_end + SETTLE then
+    return
+  end
+
+  harness.log("VRAM: %d PPU_DATA writes in %d frames, avg %d, peak %d (frame %d)",
+    data_writes, byte_frames, byte_frames > 0 and math.floor(byte_total / byte_frames) or 0,
+    byte_peak, peak_frame)
+  harness.log("redundant PPU_DATA writes: %d", redundant_data)
+  harness.log("redundant PPU_ADDR sets: %d of %d", redundant_addr, addr_sets)
+  for site, count in pairs(mask_mid_frame) do
+    harness.log("mid-frame PPU_MASK change: %s (%d)", site, count)
+  end
+  for _, site in ipairs(unsafe_order) do
+    local entry = unsafe[site]
+    harness.fail("%s with rendering on outside vblank: %s, %d write(s), first frame %d line %d",
+      entry.what, site, entry.count, entry.frame, entry.scanline)
+  end
+  harness.finish()
+end)
@@ -0,0 +1,41 @@
+-- Self-benchmark ROM (make selfbench).
+--
+-- The ROM solves levels 1-8 by itself and fills its results block at $07F0
+-- (selfbench_result_t in src/selfbench.h). This mode waits for the done
+-- marker, logs the figures and fails if the run did not finish, made the
+-- wrong number of moves or had a frame whose work missed the vblank.
+
+local BLOCK = 0x07F0
+local DONE = 0xA5           -- SELFBENCH_DONE
+local MOVES = 502           -- 2^n - 1 for n = 1..8
+local TIMEOUT = 3000        -- frames
+local REGIONS = { [0] = "NTSC", [1] = "PAL", [2] = "Dendy" }
+
+local function byte(offset)
+  return emu.read(BLOCK + offset, emu.memType.nesMemory)
+end
+
+local function word(offset)
+  return byte(offset) + byte(offset + 1) * 256
+end
+
+harness.on_frame(function()
+  if byte(0) ~= DONE then
+    if harness.frame >= TIMEOUT then
+      harness.fail("not done after %d frames", TIMEOUT)
+      harness.finish()
+    end
+    return
+  end
+
+  local frames, lag, moves = word(2), word(4), word(6)
+  harness.log("SELFBENCH region = %s, frames = %d, lag = %d, worst_lines = %d, moves = %d, peak_moves = %d",
+    REGIONS[byte(1)] or "?", frames, lag, word(8), moves, byte(10))
+  if moves ~= MOVES then
+    harness.fail("%d moves, want %d", moves, MOVES)
+  end
+  if lag > 0 then
+    harness.fail("%d lag frame(s)", lag)
+  end
+  harness.finish()
+end)
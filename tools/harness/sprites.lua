@@ -0,0 +1,85 @@
+-- Sprites per scanline.
+--
+-- Plays levels 1-5 optimally, then reads OAM every frame and counts the
+-- sprites on each scanline. Lines with more than 8 are where the PPU drops
+-- sprites; the game must rotate its OAM order there, so a sprite may flicker
+-- but never stay hidden. Fails if any sprite is dropped for more than
+-- DROPOUT_FRAMES frames in a row, and reports the worst line count seen.
+
+local LIMIT = 8
+local DROPOUT_FRAMES = 30
+local LAST_LEVEL = 5
+
+local first_frame = nil
+local worst_count, worst_frame, worst_line = 0, nil, nil
+local crowded_frames = 0
+local hidden_since = {}    -- sprite key -> first frame it was dropped
+
+local function read_oam()
+  local sprites = {}
+  for i = 0, 63 do
+    local y = emu.read(i * 4, emu.memType.nesSpriteRam)
+    if y < 0xEF then
+      sprites[#sprites + 1] = {
+        y = y,
+        key = string.format("%02x:%02x:%02x", y,
+          emu.read(i * 4 + 1, emu.memType.nesSpriteRam),
+          emu.read(i * 4 + 3, emu.memType.nesSpriteRam)),
+      }
+    end
+  end
+  return sprites
+end
+
+harness.press(30, { start = true })
+local done_at = harness.play_levels(90, LAST_LEVEL, 4)
+
+harness.on_frame(function()
+  if harness.frame < 90 then
+    return
+  end
+
+  -- Scanline s shows sprites with OAM Y in s-8 .. s-1 (Y is one line early),
+  -- in OAM order; everything after the 8th is dropped on that line.
+  local sprites = read_oam()
+  local count = {}
+  local dropped = {}
+  local crowded = false
+  for _, sp in ipairs(sprites) do
+    for line = sp.y + 1, sp.y + 8 do
+      count[line] = (count[line] or 0) + 1
+      if count[line] > LIMIT then
+        dropped[sp.key] = true
+        crowded = true
+      end
+      if count[line] > worst_count then
+        worst_count, worst_frame, worst_line = count[line], harness.frame, line
+      end
+    end
+  end
+  if crowded then
+    crowded_frames = crowded_frames + 1
+  end
+
+  for _, sp in ipairs(sprites) do
+    if dropped[sp.key] then
+      hidden_since[sp.key] = hidden_since[sp.key] or harness.frame
+      if harness.frame - hidden_since[sp.key] == DROPOUT_FRAMES then
+        harness.fail("frame %d: sprite %s dropped for %d frames", harness.frame, sp.key, DROPOUT_FRAMES)
+      end
+    else
+      hidden_since[sp.key] = nil
+    end
+  end
+  for key in pairs(hidden_since) do
+    if not dropped[key] then
+      hidden_since[key] = nil   -- moved or shown again
+    end
+  end
+
+  if harness.frame >= done_at + 60 then
+    harness.log("worst scanline: %d sprites (frame %s, line %s); %d crowded frames",
+      worst_count, tostring(worst_frame), tostring(worst_line), crowded_frames)
+    harness.finish()
+  end
+end)
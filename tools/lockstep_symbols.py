@@ -0,0 +1,82 @@
+#!/usr/bin/env python3
+"""List a ROM's RAM variables from its ld65 debug file for harness-lockstep.
+
+Every C variable in internal RAM ($0000-$07FF), statics included (objects
+assembled with -g), becomes { name, address, size } in a Lua table sorted
+by name, so two builds with different RAM layouts can be compared variable
+by variable. A size the debug file leaves out runs to the next variable or
+the end of the segment. Names defined twice (file statics in two modules)
+get "#2", "#3" in address order.
+"""
+
+import argparse
+import re
+
+RAM_END = 0x0800
+
+ATTR_RE = re.compile(r'(\w+)=("[^"]*"|[^,]*)')
+
+
+def parse(path):
+    segs = {}
+    syms = []
+    with open(path) as f:
+        for line in f:
+            kind, _, rest = line.strip().partition("\t")
+            if kind not in ("seg", "sym"):
+                continue
+            attrs = dict((k, v.strip('"')) for k, v in ATTR_RE.findall(rest))
+            if kind == "seg":
+                segs[attrs["id"]] = (int(attrs["start"], 16), int(attrs["size"], 16))
+            elif attrs.get("type") == "lab" and "val" in attrs and "seg" in attrs:
+                syms.append(attrs)
+    return segs, syms
+
+
+def ram_variables(segs, syms):
+    by_seg = {}
+    for s in syms:
+        addr = int(s["val"], 16)
+        if not s["name"].startswith("_") or addr >= RAM_END:
+            continue
+        by_seg.setdefault(s["seg"], []).append((addr, s["name"][1:], int(s.get("size", "0"))))
+
+    variables = []
+    for seg, entries in by_seg.items():
+        start, size = segs[seg]
+        entries.sort()
+        for i, (addr, name, length) in enumerate(entries):
+            end = entries[i + 1][0] if i + 1 < len(entries) else start + size
+            if length == 0:
+                length = end - addr
+            if length > 0:
+                variables.append((name, addr, length))
+
+    variables.sort(key=lambda v: (v[0], v[1]))
+    seen = {}
+    named = []
+    for name, addr, length in variables:
+        seen[name] = seen.get(name, 0) + 1
+        if seen[name] > 1:
+            name = "%s#%d" % (name, seen[name])
+        named.append((name, addr, length))
+    named.sort()
+    return named
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--dbg", required=True, help="ld65 debug file (--dbgfile)")
+    parser.add_argument("--var", default="lockstep_symbols", help="Lua table name")
+    args = parser.parse_args()
+
+    segs, syms = parse(args.dbg)
+    print("-- Generated by tools/lockstep_symbols.py - do not edit")
+    print("%s = {" % args.var)
+    for name, addr, length in ram_variables(segs, syms):
+        print('  { "%s", 0x%04X, %d },' % (name, addr, length))
+    print("}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,128 @@
+#!/usr/bin/env python3
+"""Report PRG-ROM use per module and per table from an ld65 map file.
+
+Module sizes come from the map's "Modules list". Table sizes come from the
+label file (-Ln): each C/asm object in RODATA (names starting with "_"; the
+objects must be built with -g so statics are listed) runs to the next label
+or the end of the segment. Everything loaded into the PRG memory area counts:
+code, read-only data and the ROM image of initialized DATA.
+
+With --ram, also totals DATA and BSS against the RAM area (static locals
+from cc65 -Cl land in BSS). Exits non-zero when either is over budget.
+"""
+
+import argparse
+import os
+import re
+
+ROM_SEGMENTS = ("STARTUP", "LOWCODE", "ONCE", "INIT", "CODE", "RODATA", "DATA", "VECTORS")
+COLUMNS = ("CODE", "RODATA", "DATA")
+TOP_TABLES = 20
+
+MODULE_RE = re.compile(r"^(\S.*):$")
+MODULE_SEG_RE = re.compile(r"^\s+(\w+)\s+Offs\s*=\s*[0-9A-Fa-f]+\s+Size\s*=\s*([0-9A-Fa-f]+)")
+SEGMENT_RE = re.compile(r"^(\w+)\s+([0-9A-Fa-f]{6})\s+([0-9A-Fa-f]{6})\s+([0-9A-Fa-f]{6})")
+LABEL_RE = re.compile(r"^al\s+([0-9A-Fa-f]+)\s+\.(\S+)$")
+
+
+def read_map(path):
+    modules = {}
+    segments = {}
+    section = None
+    module = None
+    with open(path) as f:
+        for line in f:
+            line = line.rstrip("\n")
+            if line.startswith("Modules list"):
+                section = "modules"
+                continue
+            if line.startswith("Segment list"):
+                section = "segments"
+                continue
+            if line.startswith("Exports list") or line.startswith("Imports list"):
+                section = None
+                continue
+            if section == "modules":
+                m = MODULE_RE.match(line)
+                if m:
+                    module = m.group(1)
+                    modules.setdefault(module, {})
+                    continue
+                m = MODULE_SEG_RE.match(line)
+                if m and module:
+                    seg = m.group(1)
+                    modules[module][seg] = modules[module].get(seg, 0) + int(m.group(2), 16)
+            elif section == "segments":
+                m = SEGMENT_RE.match(line)
+                if m:
+                    segments[m.group(1)] = (int(m.group(2), 16), int(m.group(3), 16))
+    return modules, segments
+
+
+def read_tables(path, start, end):
+    addrs = {}
+    with open(path) as f:
+        for line in f:
+            m = LABEL_RE.match(line.strip())
+            if m:
+                addr = int(m.group(1), 16)
+                if start <= addr <= end:
+                    addrs.setdefault(addr, m.group(2))
+    ordered = sorted(addrs.items())
+    tables = []
+    for i, (addr, name) in enumerate(ordered):
+        nxt = ordered[i + 1][0] if i + 1 < len(ordered) else end + 1
+        if name.startswith("_") and not name.startswith("__"):
+            tables.append((nxt - addr, name[1:]))
+    return sorted(tables, reverse=True)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--map", required=True, help="ld65 map file (-m)")
+    parser.add_argument("--labels", required=True, help="ld65 label file (-Ln)")
+    parser.add_argument("--budget", type=int, required=True, help="PRG-ROM bytes")
+    parser.add_argument("--ram", type=int, help="RAM area bytes for DATA + BSS")
+    args = parser.parse_args()
+
+    modules, segments = read_map(args.map)
+
+    print("%-24s %6s %6s %6s %6s %6s" % (("Module",) + COLUMNS + ("Other", "Total")))
+    rows = []
+    for name, segs in modules.items():
+        total = sum(size for seg, size in segs.items() if seg in ROM_SEGMENTS)
+        if total:
+            rows.append((total, name, segs))
+    for total, name, segs in sorted(rows, reverse=True):
+        cols = tuple(segs.get(c, 0) for c in COLUMNS)
+        print("%-24s %6d %6d %6d %6d %6d" % (
+            (os.path.basename(name),) + cols + (total - sum(cols), total)))
+
+    if "RODATA" in segments:
+        start, end = segments["RODATA"]
+        print("\nLargest RODATA tables")
+        for size, name in read_tables(args.labels, start, end)[:TOP_TABLES]:
+            print("  %-22s %6d" % (name, size))
+
+    used = sum(end - start + 1 for name, (start, end) in segments.items()
+               if name in ROM_SEGMENTS)
+    over = False
+    print("\nPRG-ROM: %d of %d bytes, %d free" % (used, args.budget, args.budget - used))
+    if used > args.budget:
+        print("PRG-ROM over budget by %d bytes" % (used - args.budget))
+        over = True
+
+    if args.ram:
+        ram = sum(end - start + 1 for name, (start, end) in segments.items()
+                  if name in ("DATA", "BSS"))
+        print("RAM: %d of %d bytes, %d free" % (ram, args.ram, args.ram - ram))
+        if ram > args.ram:
+            print("RAM over budget by %d bytes" % (ram - args.ram))
+            over = True
+
+    if over:
+        raise SystemExit(1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,131 @@
+#!/usr/bin/env python3
+"""Dump and total the performance telemetry ring from a battery save.
+
+The .sav file is the cartridge's 8KB SRAM as emulators and flash carts
+write it ($6000 at offset 0). The ring's address comes from the ROM's ld65
+label file (-Ln), so the save must come from the same build. Records whose
+magic byte or Fletcher-16 sum is wrong (never written, or cut off by a
+power loss) are skipped. Layout: telemetry_record_t in src/telemetry.h.
+
+Prints each record oldest first, then the totals: lag frames, frames run
+into vblank, the worst frame in scanlines of CPU work and the average
+frames per level clear.
+"""
+
+import argparse
+import re
+import struct
+
+SRAM_START = 0x6000
+SRAM_SIZE = 0x2000
+MAGIC = 0x54
+RECORDS = 16          # TELEMETRY_RECORDS
+LEVELS = 8            # MAX_BLOCKS
+
+RECORD = struct.Struct("<BBBHHHH%dH%dBBB" % (LEVELS, LEVELS))
+
+REGIONS = ("NTSC", "PAL", "Dendy")
+# Scanlines per frame and frame_idle() iterations per scanline in 1/16
+# units (12 cycles each), as in src/selfbench.c
+FRAME_LINES = (262, 312, 312)
+LINE_ITERS16 = (152, 142, 152)
+
+LABEL_RE = re.compile(r"^al\s+([0-9A-Fa-f]+)\s+\.(\S+)$")
+
+
+def ring_address(path):
+    with open(path) as f:
+        for line in f:
+            m = LABEL_RE.match(line.strip())
+            if m and m.group(2) == "_telemetry_ring":
+                return int(m.group(1), 16)
+    raise SystemExit("_telemetry_ring not in %s" % path)
+
+
+def checksum(raw):
+    s1 = s2 = MAGIC
+    for b in raw[1:RECORD.size - 2]:
+        s1 = (s1 + b) & 0xFF
+        s2 = (s2 + s1) & 0xFF
+    return s1, s2
+
+
+def read_records(sav, addr):
+    base = addr - SRAM_START
+    records = []
+    for i in range(RECORDS):
+        raw = sav[base + i * RECORD.size:base + (i + 1) * RECORD.size]
+        if len(raw) < RECORD.size or raw[0] != MAGIC:
+            continue
+        if checksum(raw) != (raw[-2], raw[-1]):
+            continue
+        f = RECORD.unpack(raw)
+        records.append({
+            "seq": f[1],
+            "region": f[2],
+            "frames": f[3],
+            "lag_frames": f[4],
+            "overruns": f[5],
+            "min_idle": f[6],
+            "level_frames": f[7:7 + LEVELS],
+            "level_clears": f[7 + LEVELS:7 + 2 * LEVELS],
+        })
+    if not records:
+        return []
+    # Oldest first: the record after the largest wrapping gap in seq
+    records.sort(key=lambda r: r["seq"])
+    gaps = [(records[(i + 1) % len(records)]["seq"] - r["seq"]) & 0xFF
+            for i, r in enumerate(records)]
+    start = (gaps.index(max(gaps)) + 1) % len(records)
+    return records[start:] + records[:start]
+
+
+def worst_lines(rec):
+    """Scanlines of CPU work in the worst frame, or None if none was timed"""
+    if rec["min_idle"] == 0xFFFF:
+        return None
+    region = min(rec["region"], len(REGIONS) - 1)
+    spare = rec["min_idle"] * 16 // LINE_ITERS16[region]
+    return max(FRAME_LINES[region] - spare, 0)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--sav", required=True, help="8KB battery save")
+    parser.add_argument("--labels", required=True, help="ld65 label file (-Ln) of the ROM")
+    args = parser.parse_args()
+
+    with open(args.sav, "rb") as f:
+        sav = f.read(SRAM_SIZE)
+    records = read_records(sav, ring_address(args.labels))
+    if not records:
+        print("No telemetry records")
+        return
+
+    print("%4s %-6s %7s %6s %9s %6s" % ("Seq", "Region", "Frames", "Lag", "Overruns", "Worst"))
+    for rec in records:
+        lines = worst_lines(rec)
+        print("%4d %-6s %7d %6d %9d %6s" % (
+            rec["seq"], REGIONS[min(rec["region"], len(REGIONS) - 1)], rec["frames"],
+            rec["lag_frames"], rec["overruns"], "-" if lines is None else "%d" % lines))
+
+    frames = sum(r["frames"] for r in records)
+    lag = sum(r["lag_frames"] for r in records)
+    overruns = sum(r["overruns"] for r in records)
+    worst = [l for l in (worst_lines(r) for r in records) if l is not None]
+    print("\n%d records, %d frames" % (len(records), frames))
+    print("Lag frames: %d (%.2f%%)" % (lag, 100.0 * lag / frames if frames else 0.0))
+    print("Frames run into vblank: %d" % overruns)
+    if worst:
+        print("Worst frame: %d scanlines of work" % max(worst))
+
+    print("\nLevel  Clears  Avg frames")
+    for level in range(LEVELS):
+        clears = sum(r["level_clears"][level] for r in records)
+        total = sum(r["level_frames"][level] for r in records)
+        if clears:
+            print("%5d  %6d  %10.1f" % (level + 1, clears, float(total) / clears))
+
+
+if __name__ == "__main__":
+    main()